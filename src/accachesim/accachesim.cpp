@@ -0,0 +1,238 @@
+/* ex: set tabstop=2 expandtab: */
+/**
+ * @file      accachesim.cpp
+ * @author    The ArchC Team
+ *
+ *            Computer Systems Laboratory (LSC)
+ *            IC-UNICAMP
+ *            http://www.lsc.ic.unicamp.br
+ *
+ * @version   0.1
+ *
+ * @brief     Offline trace-driven cache simulator.
+ *
+ *   Usage: accachesim [-j N] trace hierarchy [hierarchy ...]
+ *
+ *   A hierarchy is a list of levels separated by '/', first level first.
+ *   Each level is  size:assoc:block[:policy[:wt]]  where size accepts k/m
+ *   suffixes, policy is random, fifo, lru (default), plrum, treeplru,
+ *   srrip, brrip or drrip, and wt selects write-through (write-back
+ *   otherwise). Example:
+ *
+ *     accachesim -j 8 dcache.trace 16k:2:32 32k:4:32:plrum/256k:8:64:lru
+ *
+ *   The trace may be in any ac_cache_trace format. Hierarchies are
+ *   simulated in parallel, one per host thread; each thread reads the
+ *   trace on its own. As in the simulators, addresses from MEM_SIZE_ up
+ *   go around the caches.
+ *
+ * @attention Copyright (C) 2002-2006 --- The ArchC Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "accachesim.H"
+#include "ac_cache_trace.H"
+
+using namespace std;
+
+static void fatal(const string &msg)
+{
+  fprintf(stderr, "accachesim: %s\n", msg.c_str());
+  exit(EXIT_FAILURE);
+}
+
+/*
+ * trace_memory
+ */
+
+const uint32_t *trace_memory::read_block(uint32_t a, unsigned length)
+{
+  return &zeros[0];
+}
+
+void trace_memory::setBlockSize(unsigned size)
+{
+  if (size / sizeof(uint32_t) > zeros.size())
+    zeros.resize(size / sizeof(uint32_t), 0);
+}
+
+/*
+ * trace_hierarchy
+ */
+
+trace_hierarchy::trace_hierarchy(const string &s) : spec(s), first(NULL)
+{
+  string level;
+  istringstream in(spec);
+
+  while (getline(in, level, '/'))
+    config.push_back(ac_cache_geometry::parse(level));
+  if (config.empty())
+    fatal("empty hierarchy");
+
+  // build from the last level, so each one knows its successor
+  links.resize(config.size());
+  levels.resize(config.size() - 1);
+  links[config.size()-1] = new trace_link(memory);
+  for (size_t i = config.size(); i-- > 1; ) {
+    levels[i-1] = new ac_cache_level<uint32_t>(*links[i], config[i]);
+    links[i-1] = new trace_link(*levels[i-1]);
+  }
+  first = new ac_runtime_cache<uint32_t, ac_cache_memory<uint32_t> >(*links[0], config[0]);
+}
+
+trace_hierarchy::~trace_hierarchy()
+{
+  delete first;
+  for (size_t i = 0; i < levels.size(); i++)
+    delete levels[i];
+  for (size_t i = 0; i < links.size(); i++)
+    delete links[i];
+}
+
+void trace_hierarchy::access(bool write, uint32_t a, unsigned length)
+{
+  uint32_t last = a + (length ? length - 1 : 0);
+  uint32_t block = config[0].block_size;
+  uint32_t word = 0;
+
+  // one access per first-level block touched by the record
+  for (;;) {
+    uint32_t w = a & ~(uint32_t) (sizeof(word) - 1);
+    if (write)
+      first->write(w, &word, sizeof(word));
+    else
+      first->read(w, sizeof(word));
+    uint32_t next = (a | (block - 1)) + 1;
+    if (next == 0 || next > last)
+      break;
+    a = next;
+  }
+}
+
+void trace_hierarchy::print_statistics(ostream &out)
+{
+  out << "Hierarchy " << spec << endl;
+  for (size_t i = 0; i < config.size(); i++) {
+    cache_statistics stats;
+    if (i == 0)
+      first->get_statistics(&stats);
+    else
+      levels[i-1]->get_statistics(&stats);
+
+    unsigned long long total_read = stats.read_miss + stats.read_hit;
+    unsigned long long total_write = stats.write_miss + stats.write_hit;
+
+    if (total_read == 0) total_read = 1;
+    if (total_write == 0) total_write = 1;
+
+    out << "L" << i+1 << ": " << config[i].size << " bytes, " << config[i].associativity
+        << "-way, " << config[i].block_size << "-byte blocks, " << config[i].policy
+        << (config[i].write_through ? ", write-through" : ", write-back") << endl;
+    out << "Read:   miss: " << stats.read_miss << " ("
+        << (stats.read_miss/(float)total_read)*100 << "%) hit: "
+        << stats.read_hit << " ("
+        << (stats.read_hit/(float)total_read)*100 << "%)" << endl;
+    out << "Write:  miss: " << stats.write_miss << " ("
+        << (stats.write_miss/(float)total_write)*100 << "%) hit: "
+        << stats.write_hit << " ("
+        << (stats.write_hit/(float)total_write)*100 << "%)" << endl;
+    out << "Number of block evictions: " << stats.evictions
+        << " (" << links[i]->written_back() << " written back)" << endl;
+  }
+}
+
+/*
+ * Trace replay
+ */
+
+// Replays a trace written by ac_cache_trace, text or binary.
+static void replay(const char *trace, trace_hierarchy &h)
+{
+  ifstream in(trace, ios::in | ios::binary);
+  trace_operation o;
+  unsigned a, l;
+
+  if (!in) {
+    perror(trace);
+    exit(EXIT_FAILURE);
+  }
+
+  ac_cache_trace_reader reader(in);
+  while (reader.next(o, a, l))
+    h.access(o == trace_write, a, l);
+}
+
+static void usage(const char *prog)
+{
+  fprintf(stderr,
+          "Usage: %s [-j N] trace hierarchy [hierarchy ...]\n"
+          "  hierarchy: level[/level...]\n"
+          "  level:     size:assoc:block[:policy[:wb|wt]]\n"
+          "  policy:    random|fifo|lru|plrum|treeplru|srrip|brrip|drrip\n"
+          "  -j N       number of hierarchies simulated in parallel\n",
+          prog);
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+  unsigned jobs = thread::hardware_concurrency();
+  int arg = 1;
+
+  if (arg < argc && !strcmp(argv[arg], "-j")) {
+    if (arg + 1 >= argc)
+      usage(argv[0]);
+    jobs = strtoul(argv[arg+1], NULL, 0);
+    arg += 2;
+  }
+  if (argc - arg < 2)
+    usage(argv[0]);
+  if (jobs == 0)
+    jobs = 1;
+
+  const char *trace = argv[arg++];
+
+  // parse everything up front, so errors show before any replay
+  vector<trace_hierarchy*> config;
+  for (; arg < argc; arg++)
+    config.push_back(new trace_hierarchy(argv[arg]));
+
+  atomic<size_t> next_job(0);
+  vector<thread> workers;
+  for (unsigned t = 0; t < jobs && t < config.size(); t++)
+    workers.push_back(thread([&]() {
+      size_t j;
+      while ((j = next_job++) < config.size())
+        replay(trace, *config[j]);
+    }));
+  for (size_t t = 0; t < workers.size(); t++)
+    workers[t].join();
+
+  for (size_t j = 0; j < config.size(); j++) {
+    config[j]->print_statistics(cout);
+    cout << endl;
+    delete config[j];
+  }
+
+  return 0;
+}
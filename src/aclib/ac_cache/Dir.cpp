@@ -1,74 +1,113 @@
-
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "Dir.h"
 
 
-Dir::Dir()
+Dir::Dir() : invalidations(0)
 {
-	started=0;
-	totalOfCaches=MAX_NUMBER_OF_CACHES;
-	index_size = MAX_INDEX_SIZE;
-	// log.open("dirLog.txt", fstream::out);
-	for(int i=0; i<totalOfCaches;i++){
-		cacheMemVector[i].numberCache = i;
-	}
-	start(2, index_size);
+}
 
+Dir::~Dir()
+{
 }
 
-void Dir::start(int n, int index)
+int Dir::attach(ac_dir_client *cache)
 {
-	if(started != 0)
-		return;
-	started++;
-	index_size = index;
-	for(int i=0; i<totalOfCaches;i++){
-		cacheMemVector[i].nWay = n;
-		cacheMemVector[i].alocate_blocks(index_size);
+	// every cache gets an id of its own, so the instruction and data
+	// caches of a processor are told apart
+	if (caches.size() == AC_DIR_MAX_CACHES) {
+		fprintf(stderr, "ArchC: coherence directory supports up to %d caches.\n",
+		        AC_DIR_MAX_CACHES);
+		exit(EXIT_FAILURE);
 	}
+	caches.push_back(cache);
+	return caches.size() - 1;
 }
 
-Dir::~Dir()
+void Dir::read(int id, uint32_t line)
 {
-	//log.close();
+	entry &e = lines[line];     // new entries start zeroed
+
+	if (!has(e, id))
+		add(e, id);
+	// a second reader demotes an exclusive or modified owner; caches
+	// write through, so memory is already up to date
+	if (e.count > 1)
+		e.state = SHARED;
+	else if (e.state != MODIFIED)
+		e.state = EXCLUSIVE;
 }
 
+// Invalidates the sharers of 'line' other than 'id', and only those, and
+// leaves the entry with no sharers.
+void Dir::invalidate_sharers(entry &e, int id, uint32_t line)
+{
+	for (unsigned w = 0; w < AC_DIR_SHARER_WORDS; w++) {
+		uint64_t s = e.sharers[w];
+		while (s) {
+			int other = w * 64 + __builtin_ctzll(s);
+			s &= s - 1;
+			if (other != id) {
+				caches[other]->invalidate_address(line);
+				invalidations++;
+			}
+		}
+	}
+	memset(e.sharers, 0, sizeof(e.sharers));
+	e.count = 0;
+}
 
-
-bool Dir::validate(int numberCache, uint32_t address, int cacheAddress)
+void Dir::write(int id, uint32_t line)
 {
-	
-	cacheMemVector[numberCache].validate(address, cacheAddress);
-	return true;
+	entry &e = lines[line];
 
+	if (e.count > 1 || (e.count == 1 && !has(e, id)))
+		invalidate_sharers(e, id, line);
+	if (!has(e, id))
+		add(e, id);
+	e.state = MODIFIED;
 }
 
-
-bool Dir::checkValidation(int numberCache, uint32_t address, int cacheIndex)
+void Dir::invalidate_others(int id, uint32_t line)
 {
-	if(cacheMemVector[numberCache].checkValidation(address, cacheIndex))
-	{
-		return true;
+	std::unordered_map<uint32_t, entry>::iterator i = lines.find(line);
+
+	if (i == lines.end())
+		return;
+	bool kept = has(i->second, id);
+	invalidate_sharers(i->second, id, line);
+	// memory is up to date, so a copy of 'id' is the only one left
+	if (kept) {
+		add(i->second, id);
+		i->second.state = EXCLUSIVE;
 	}
-	return false;
+	else
+		lines.erase(i);
 }
 
-void Dir::unvalidate(int numberCache, uint32_t address, int cacheBlockIndex)
+void Dir::evict(int id, uint32_t line)
 {
+	std::unordered_map<uint32_t, entry>::iterator i = lines.find(line);
 
-	for(int i=0; i<totalOfCaches;i++)
-		if(cacheMemVector[i].numberCache != numberCache)
-		{
-			cacheMemVector[i].invalidate(address, cacheBlockIndex);
-		}
+	if (i == lines.end() || !has(i->second, id))
+		return;
+	i->second.sharers[id / 64] &= ~((uint64_t)1 << (id % 64));
+	if (--i->second.count == 0)
+		lines.erase(i);
+	else if (i->second.count == 1)
+		i->second.state = EXCLUSIVE;
 }
 
+bool Dir::holds(int id, uint32_t line) const
+{
+	std::unordered_map<uint32_t, entry>::const_iterator i = lines.find(line);
+	return i != lines.end() && has(i->second, id);
+}
 
-void Dir::checkNumberCache(int numberCache)
+Dir::state_t Dir::state(uint32_t line) const
 {
-	for(int i=0; i<totalOfCaches;i++)
-	{
-		if(numberCache == cacheMemVector[i].numberCache)
-			return;
-	}
+	std::unordered_map<uint32_t, entry>::const_iterator i = lines.find(line);
+	return (i == lines.end()) ? INVALID : i->second.state;
 }
@@ -1,28 +1,82 @@
 #ifndef DIR_H
 #define DIR_H
 
-#define MAX_NUMBER_OF_CACHES 64
-#define MAX_INDEX_SIZE 1024
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
 
-#include "cacheMem.h"
+//! Largest number of caches a directory can track.
+#define AC_DIR_MAX_CACHES 256
+#define AC_DIR_SHARER_WORDS ((AC_DIR_MAX_CACHES + 63) / 64)
 
+/**
+ * A cache kept coherent by Dir. The directory calls back into it to drop
+ * its copy of a line another cache is about to write.
+ */
+class ac_dir_client
+{
+	public:
+		virtual ~ac_dir_client() {}
+		virtual void invalidate_address(uint32_t line) = 0;
+};
+
+/**
+ * Sparse MESI coherence directory.
+ *
+ * Only lines currently held by some cache have an entry, found by hashing
+ * the line address. Each entry holds the line state and a bitvector of the
+ * caches sharing it, so a write invalidates just those caches, and the
+ * cost of coherence does not depend on how many caches are attached.
+ *
+ * Line addresses are byte addresses aligned to the cache block size.
+ */
 class Dir
 {
 	public:
-		//fstream log;
-		int totalOfCaches, index_size, started;
-		cacheMem cacheMemVector[MAX_NUMBER_OF_CACHES];
+		enum state_t { INVALID = 'I', SHARED = 'S', EXCLUSIVE = 'E', MODIFIED = 'M' };
+
 		Dir();
-		Dir(int p){totalOfCaches=p;}
 		virtual ~Dir();
-		void start(int, int);
-		bool checkValidation(int, uint32_t, int);
-		void checkNumberCache(int);
-		bool validate(int, uint32_t, int);
-		void unvalidate(int, uint32_t, int);
+
+		//! Registers a cache; returns the id naming it in the other calls.
+		int attach(ac_dir_client *cache);
+		//! Cache 'id' fetched 'line' for reading.
+		void read(int id, uint32_t line);
+		//! Cache 'id' writes 'line'; every other sharer is invalidated.
+		void write(int id, uint32_t line);
+		//! Cache 'id' writes 'line' around its copies (set-sampled caches):
+		//! every other sharer is invalidated, and 'id' does not become one.
+		void invalidate_others(int id, uint32_t line);
+		//! Cache 'id' evicted 'line'.
+		void evict(int id, uint32_t line);
+
+		bool holds(int id, uint32_t line) const;
+		state_t state(uint32_t line) const;
+
+		unsigned long long number_invalidations() const { return invalidations; }
+		size_t tracked_lines() const { return lines.size(); }
 
 	protected:
 	private:
+		struct entry {
+			state_t state;
+			unsigned count;
+			uint64_t sharers[AC_DIR_SHARER_WORDS];
+		};
+
+		std::unordered_map<uint32_t, entry> lines;
+		std::vector<ac_dir_client *> caches;
+		unsigned long long invalidations;
+
+		void invalidate_sharers(entry &e, int id, uint32_t line);
+
+		static bool has(const entry &e, int id) {
+			return (e.sharers[id / 64] >> (id % 64)) & 1;
+		}
+		static void add(entry &e, int id) {
+			e.sharers[id / 64] |= (uint64_t)1 << (id % 64);
+			e.count++;
+		}
 };
 
 #endif // DIR_H
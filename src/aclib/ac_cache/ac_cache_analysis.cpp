@@ -0,0 +1,121 @@
+/* ex: set tabstop=2 expandtab: */
+/**
+ * @file      ac_cache_analysis.cpp
+ * @author    The ArchC Team
+ *
+ *            Computer Systems Laboratory (LSC)
+ *            IC-UNICAMP
+ *            http://www.lsc.ic.unicamp.br
+ *
+ * @version   0.1
+ *
+ * @brief     Single-pass cache design space analysis (implementation).
+ */
+
+#include "ac_cache_analysis.H"
+
+#include <cstdio>
+#include <cstdlib>
+
+// line value that never matches a real line: empty stack entry
+static const uint32_t no_line = 0xFFFFFFFF;
+
+static unsigned log2_of(unsigned v, const char *what)
+{
+  unsigned bits = 0;
+
+  if (v == 0 || (v & (v-1)) != 0) {
+    fprintf(stderr, "ArchC: cache analysis %s must be a power of 2.\n", what);
+    exit(EXIT_FAILURE);
+  }
+  while ((1u << bits) != v)
+    bits++;
+  return bits;
+}
+
+ac_cache_analysis::ac_cache_analysis(const char *name, unsigned line_size,
+                                     unsigned max_sets, unsigned max_assoc) :
+  m_name(name),
+  m_line_bits(log2_of(line_size, "line size")),
+  m_set_levels(log2_of(max_sets, "set count") + 1),
+  m_max_assoc(max_assoc),
+  m_last_line(no_line),
+  m_repeats(0),
+  m_accesses(0),
+  m_stacks(m_set_levels),
+  m_hist(m_set_levels)
+{
+  log2_of(max_assoc, "associativity");
+
+  for (unsigned k = 0; k < m_set_levels; k++) {
+    m_stacks[k].assign((1u << k) * m_max_assoc, no_line);
+    m_hist[k].assign(m_max_assoc + 1, 0);
+  }
+}
+
+void ac_cache_analysis::update(uint32_t line)
+{
+  m_accesses++;
+
+  for (unsigned k = 0; k < m_set_levels; k++) {
+    uint32_t *stack = &m_stacks[k][(line & ((1u << k) - 1)) * m_max_assoc];
+    unsigned d = 0;
+
+    while (d < m_max_assoc && stack[d] != line)
+      d++;
+    m_hist[k][d]++;
+
+    // move to front: the line was at depth d (or beyond the stack)
+    if (d == m_max_assoc)
+      d--;
+    for (; d > 0; d--)
+      stack[d] = stack[d-1];
+    stack[0] = line;
+  }
+}
+
+double ac_cache_analysis::miss_ratio(unsigned sets, unsigned assoc) const
+{
+  unsigned long long total = m_accesses + m_repeats;
+  unsigned long long misses = 0;
+  unsigned k = 0;
+
+  while ((1u << k) < sets)
+    k++;
+  if (k >= m_set_levels || assoc == 0 || assoc > m_max_assoc || total == 0)
+    return 0.0;
+
+  for (unsigned d = assoc; d <= m_max_assoc; d++)
+    misses += m_hist[k][d];
+
+  return (double) misses / total;
+}
+
+void ac_cache_analysis::print_statistics(std::ostream &out) const
+{
+  char buf[32];
+
+  out << "Cache analysis (" << m_name << "): "
+      << m_accesses + m_repeats << " accesses, "
+      << (1u << m_line_bits) << "-byte lines, LRU" << std::endl;
+  out << "Miss ratio (%) by number of sets and associativity:" << std::endl;
+
+  out << "      sets";
+  for (unsigned a = 1; a <= m_max_assoc; a <<= 1) {
+    snprintf(buf, sizeof(buf), " %7u-way", a);
+    out << buf;
+  }
+  out << std::endl;
+
+  for (unsigned k = 0; k < m_set_levels; k++) {
+    snprintf(buf, sizeof(buf), "%10u", 1u << k);
+    out << buf;
+    for (unsigned a = 1; a <= m_max_assoc; a <<= 1) {
+      snprintf(buf, sizeof(buf), " %11.4f", miss_ratio(1u << k, a) * 100);
+      out << buf;
+    }
+    out << std::endl;
+  }
+  out << "(cache size = sets * ways * " << (1u << m_line_bits)
+      << " bytes)" << std::endl;
+}
@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "ac_cache_attribution.H"
+#include "elf32-tiny.h"
+
+void ac_cache_attribution::configure(unsigned n, const std::string &dump, const char *elf)
+{
+	unsigned bits = 0;
+
+	if (AC_CACHE_ATTR_ENTRIES & (AC_CACHE_ATTR_ENTRIES - 1)) {
+		fprintf(stderr, "ArchC: AC_CACHE_ATTR_ENTRIES must be a power of 2.\n");
+		exit(EXIT_FAILURE);
+	}
+	while ((1u << bits) < AC_CACHE_ATTR_ENTRIES)
+		bits++;
+
+	top = n;
+	dump_file = dump;
+	hash_shift = 32 - bits;
+	table.assign(n ? AC_CACHE_ATTR_ENTRIES : 0, entry());
+	untracked = entry();
+	symbols.clear();
+	if (n && elf)
+		load_symbols(elf);
+	else if (n)
+		fprintf(stderr, "ArchC: cache miss attribution: no application ELF known, reporting raw PCs.\n");
+}
+
+// ELF fields are in the target's byte order
+static uint32_t elf_word(uint32_t w, bool swap)
+{
+	return swap ? __builtin_bswap32(w) : w;
+}
+
+static uint16_t elf_half(uint16_t h, bool swap)
+{
+	return swap ? __builtin_bswap16(h) : h;
+}
+
+// Reads 'size' bytes at 'offset'; false on a short file.
+static bool read_at(FILE *f, long offset, void *buf, size_t size)
+{
+	return fseek(f, offset, SEEK_SET) == 0 && fread(buf, 1, size, f) == size;
+}
+
+void ac_cache_attribution::load_symbols(const char *elf)
+{
+	FILE *f = fopen(elf, "rb");
+	Elf32_Ehdr ehdr;
+
+	if (!f)
+		return;
+	if (!read_at(f, 0, &ehdr, sizeof(ehdr)) || memcmp(ehdr.e_ident, ELFMAG, SELFMAG)) {
+		fclose(f);
+		return;
+	}
+
+	uint16_t probe = 1;
+	bool host_little = *(uint8_t *) &probe == 1;
+	bool swap = host_little != (ehdr.e_ident[EI_DATA] == ELFDATA2LSB);
+	uint32_t shoff = elf_word(ehdr.e_shoff, swap);
+	unsigned shnum = elf_half(ehdr.e_shnum, swap);
+	unsigned shentsize = elf_half(ehdr.e_shentsize, swap);
+
+	// the symbol table links to its string table
+	for (unsigned i = 0; i < shnum; i++) {
+		Elf32_Shdr symtab, strtab;
+		if (!read_at(f, shoff + i * shentsize, &symtab, sizeof(symtab)))
+			break;
+		if (elf_word(symtab.sh_type, swap) != SHT_SYMTAB)
+			continue;
+		if (!read_at(f, shoff + elf_word(symtab.sh_link, swap) * shentsize, &strtab, sizeof(strtab)))
+			break;
+
+		std::vector<char> names(elf_word(strtab.sh_size, swap) + 1, 0);
+		if (!read_at(f, elf_word(strtab.sh_offset, swap), &names[0], names.size() - 1))
+			break;
+
+		unsigned count = elf_word(symtab.sh_size, swap) / sizeof(Elf32_Sym);
+		std::vector<Elf32_Sym> syms(count);
+		if (count && !read_at(f, elf_word(symtab.sh_offset, swap), &syms[0], count * sizeof(Elf32_Sym)))
+			break;
+
+		for (unsigned k = 0; k < count; k++) {
+			uint32_t name = elf_word(syms[k].st_name, swap);
+			if (ELF32_ST_TYPE(syms[k].st_info) != STT_FUNC ||
+			    elf_half(syms[k].st_shndx, swap) == SHN_UNDEF || name >= names.size())
+				continue;
+			symbol s;
+			s.addr = elf_word(syms[k].st_value, swap);
+			s.size = elf_word(syms[k].st_size, swap);
+			s.name = &names[name];
+			symbols.push_back(s);
+		}
+		break;
+	}
+	fclose(f);
+	std::sort(symbols.begin(), symbols.end());
+}
+
+// The function holding pc: the last symbol at or below it, if pc is
+// within its size (unsized symbols reach up to the next one).
+const ac_cache_attribution::symbol *ac_cache_attribution::find_symbol(uint32_t pc) const
+{
+	symbol key;
+	key.addr = pc;
+	std::vector<symbol>::const_iterator it =
+		std::upper_bound(symbols.begin(), symbols.end(), key);
+	if (it == symbols.begin())
+		return NULL;
+	--it;
+	if (it->size && pc - it->addr >= it->size)
+		return NULL;
+	return &*it;
+}
+
+std::string ac_cache_attribution::describe(uint32_t pc) const
+{
+	std::ostringstream s;
+	const symbol *sym = find_symbol(pc);
+
+	if (sym)
+		s << sym->name << "+0x" << std::hex << pc - sym->addr;
+	else
+		s << "?";
+	return s.str();
+}
+
+void ac_cache_attribution::print(std::ostream &out) const
+{
+	if (!active())
+		return;
+
+	std::vector<const entry *> ranked;
+	unsigned long long misses = untracked.misses();
+	for (size_t i = 0; i < table.size(); i++)
+		if (table[i].used()) {
+			ranked.push_back(&table[i]);
+			misses += table[i].misses();
+		}
+	std::sort(ranked.begin(), ranked.end(), more_misses);
+	if (!dump_file.empty())
+		write_dump(ranked);
+
+	size_t n = std::min<size_t>(top, ranked.size());
+	out << "Misses by instruction (top " << n << " of " << ranked.size() << "):" << std::endl;
+	for (size_t i = 0; i < n && ranked[i]->misses(); i++) {
+		const entry &e = *ranked[i];
+		out << "  0x" << std::hex << e.pc << std::dec
+		    << "  " << e.misses() << " misses ("
+		    << (misses ? 100.0 * e.misses() / misses : 0) << "%)"
+		    << "  read: " << e.read_misses << "/" << e.reads
+		    << "  write: " << e.write_misses << "/" << e.writes
+		    << "  " << describe(e.pc) << std::endl;
+	}
+	if (untracked.used())
+		out << "  untracked instructions: " << untracked.misses() << " misses in "
+		    << untracked.reads + untracked.writes << " accesses" << std::endl;
+}
+
+// Most misses first; ties by pc so the order is stable across runs.
+bool ac_cache_attribution::more_misses(const entry *a, const entry *b)
+{
+	if (a->misses() != b->misses())
+		return a->misses() > b->misses();
+	return a->pc < b->pc;
+}
+
+void ac_cache_attribution::write_dump(const std::vector<const entry *> &ranked) const
+{
+	std::ofstream dump(dump_file.c_str());
+
+	if (!dump) {
+		fprintf(stderr, "ArchC: cannot write miss attribution to '%s'.\n", dump_file.c_str());
+		return;
+	}
+	dump << "# pc\tfunction\toffset\treads\tread_misses\twrites\twrite_misses" << std::endl;
+	for (size_t i = 0; i < ranked.size(); i++) {
+		const entry &e = *ranked[i];
+		const symbol *sym = find_symbol(e.pc);
+		dump << "0x" << std::hex << e.pc << '\t'
+		     << (sym ? sym->name : "?") << "\t0x" << (sym ? e.pc - sym->addr : 0)
+		     << std::dec << '\t' << e.reads << '\t' << e.read_misses
+		     << '\t' << e.writes << '\t' << e.write_misses << std::endl;
+	}
+}
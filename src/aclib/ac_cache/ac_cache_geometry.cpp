@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sstream>
+#include <vector>
+
+#include "ac_cache_geometry.H"
+#include "ac_random_replacement_policy.H"
+#include "ac_fifo_replacement_policy.H"
+#include "ac_lru_replacement_policy.H"
+#include "ac_plrum_replacement_policy.H"
+#include "ac_tree_plru_replacement_policy.H"
+#include "ac_rrip_replacement_policy.H"
+
+static void invalid_geometry(const std::string &spec, const char *why)
+{
+	fprintf(stderr, "ArchC: invalid cache geometry '%s': %s.\n", spec.c_str(), why);
+	exit(EXIT_FAILURE);
+}
+
+static unsigned parse_size(const std::string &spec, const std::string &s)
+{
+	char *end;
+	unsigned long v = strtoul(s.c_str(), &end, 0);
+
+	if (end == s.c_str())
+		invalid_geometry(spec, "sizes must be numbers");
+	if (*end == 'k' || *end == 'K')
+		v <<= 10, end++;
+	else if (*end == 'm' || *end == 'M')
+		v <<= 20, end++;
+	if (*end)
+		invalid_geometry(spec, "sizes accept only k or m suffixes");
+	return (unsigned) v;
+}
+
+ac_cache_geometry ac_cache_geometry::parse(const std::string &spec)
+{
+	std::vector<std::string> f;
+	std::string field;
+	std::istringstream in(spec);
+	ac_cache_geometry g;
+
+	while (getline(in, field, ':'))
+		f.push_back(field);
+	if (f.size() < 3 || f.size() > 5)
+		invalid_geometry(spec, "expected size:assoc:block[:policy[:wb|wt]]");
+
+	g.size = parse_size(spec, f[0]);
+	g.associativity = parse_size(spec, f[1]);
+	g.block_size = parse_size(spec, f[2]);
+	if (f.size() > 3)
+		g.policy = f[3];
+	if (f.size() > 4) {
+		if (f[4] == "wt")
+			g.write_through = true;
+		else if (f[4] != "wb")
+			invalid_geometry(spec, "the write policy must be wb or wt");
+	}
+	g.check();
+	return g;
+}
+
+static bool power_of_2(unsigned v)
+{
+	return v && !(v & (v-1));
+}
+
+void ac_cache_geometry::check() const
+{
+	std::string spec = to_string();
+
+	if (!power_of_2(size) || !power_of_2(block_size) || !power_of_2(associativity))
+		invalid_geometry(spec, "size, associativity and block size must be powers of 2");
+	if (block_size > size || associativity > block_count())
+		invalid_geometry(spec, "the cache must hold at least one set");
+	if (policy != "random" && policy != "fifo" && policy != "lru" && policy != "plrum" &&
+	    policy != "treeplru" && policy != "srrip" && policy != "brrip" && policy != "drrip")
+		invalid_geometry(spec, "the policy must be random, fifo, lru, plrum, treeplru, srrip, brrip or drrip");
+}
+
+ac_cache_replacement_policy *ac_cache_geometry::make_policy() const
+{
+	if (policy == "random")
+		return new ac_random_replacement_policy(block_count(), associativity);
+	if (policy == "fifo")
+		return new ac_fifo_replacement_policy(block_count(), associativity);
+	if (policy == "plrum")
+		return new ac_plrum_replacement_policy(block_count(), associativity);
+	if (policy == "treeplru")
+		return new ac_tree_plru_replacement_policy(block_count(), associativity);
+	if (policy == "srrip")
+		return new ac_srrip_replacement_policy(block_count(), associativity);
+	if (policy == "brrip")
+		return new ac_brrip_replacement_policy(block_count(), associativity);
+	if (policy == "drrip")
+		return new ac_drrip_replacement_policy(block_count(), associativity);
+	return new ac_lru_replacement_policy(block_count(), associativity);
+}
+
+std::string ac_cache_geometry::to_string() const
+{
+	std::ostringstream s;
+
+	s << size << ':' << associativity << ':' << block_size << ':' << policy
+	  << (write_through ? ":wt" : ":wb");
+	return s.str();
+}
@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <sstream>
+
+#include "ac_cache_image.H"
+#include "ac_cache_replacement_policy.H"
+
+static const char image_magic[] = "ArchC cache image 1";
+static const uint32_t byte_order = 0x01020304;
+
+ac_cache_image::ac_cache_image(const std::string &file_, const std::string &layout, mode_t mode_) :
+	file(file_), mode(mode_)
+{
+	if (mode == save) {
+		stream.open(file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!stream)
+			fail("cannot be written");
+		stream << image_magic << '\n' << layout << '\n';
+		put(&byte_order, 1);
+		return;
+	}
+
+	stream.open(file.c_str(), std::ios::in | std::ios::binary);
+	if (!stream)
+		fail("cannot be read");
+
+	std::string magic, taken_from;
+	uint32_t order;
+	if (!std::getline(stream, magic) || magic != image_magic)
+		fail("is not a cache image");
+	if (!std::getline(stream, taken_from))
+		fail("is truncated");
+	if (taken_from != layout) {
+		fprintf(stderr, "ArchC: cache image '%s' was taken from another cache.\n"
+		        "  image: %s\n  cache: %s\n", file.c_str(), taken_from.c_str(), layout.c_str());
+		exit(EXIT_FAILURE);
+	}
+	get(&order, 1);
+	if (order != byte_order)
+		fail("was saved on a host of another byte order");
+}
+
+void ac_cache_image::skip(size_t size)
+{
+	stream.ignore(size);
+	if ((size_t) stream.gcount() != size)
+		fail("is truncated");
+}
+
+void ac_cache_image::put(const ac_cache_replacement_policy &policy)
+{
+	policy.save_state(stream);
+	check();
+}
+
+void ac_cache_image::get(ac_cache_replacement_policy &policy)
+{
+	if (!policy.load_state(stream))
+		fail("holds the state of another replacement policy");
+	check();
+}
+
+void ac_cache_image::close()
+{
+	if (mode == restore && stream.peek() != std::char_traits<char>::eof())
+		fail("holds more than one cache");
+	stream.close();
+	if (stream.fail())
+		fail(mode == save ? "cannot be written" : "cannot be read");
+}
+
+std::string ac_cache_image::layout(unsigned sets, unsigned associativity, unsigned block_size,
+                                   unsigned word_size, const char *status, const char *policy)
+{
+	std::ostringstream s;
+
+	s << sets << " sets, " << associativity << " ways, " << block_size
+	  << " byte blocks, " << word_size << " byte words, " << status
+	  << " status, " << policy << " policy";
+	return s.str();
+}
+
+void ac_cache_image::check()
+{
+	if (!stream)
+		fail(mode == save ? "cannot be written" : "is truncated");
+}
+
+void ac_cache_image::fail(const char *why)
+{
+	fprintf(stderr, "ArchC: cache image '%s' %s.\n", file.c_str(), why);
+	exit(EXIT_FAILURE);
+}
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ac_cache_mshr.H"
+
+void ac_cache_mshr::configure(unsigned n, unsigned miss_latency, ac_cache_clock *c)
+{
+	if (n && !c) {
+		fprintf(stderr, "ArchC: non-blocking caches need a processor clock.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	entry free_entry = { 0, 0 };
+	clock = n ? c : NULL;
+	latency = miss_latency;
+	entries.assign(n, free_entry);
+	last_ready = 0;
+	clear_stats();
+}
+
+void ac_cache_mshr::clear_stats()
+{
+	primary = merged = 0;
+	data_stalls = data_stall_cycles = 0;
+	full_stalls = full_stall_cycles = 0;
+}
+
+// Slow path of access(): some fill may still be outstanding at cycle t.
+void ac_cache_mshr::demand(uint32_t line, bool write, bool miss, uint64_t t)
+{
+	entry *pending = NULL, *oldest = &entries[0];
+
+	for (size_t i = 0; i < entries.size(); i++) {
+		entry &e = entries[i];
+		if (e.ready > t && e.line == line)
+			pending = &e;
+		if (e.ready < oldest->ready)
+			oldest = &e;
+	}
+
+	// secondary miss: merges into the outstanding fill, and reads wait for it
+	if (pending) {
+		merged++;
+		if (!write) {
+			data_stalls++;
+			data_stall_cycles += pending->ready - t;
+			clock->stall(pending->ready - t);
+		}
+		return;
+	}
+	if (!miss)
+		return;
+
+	primary++;
+	if (oldest->ready > t) {
+		full_stalls++;
+		full_stall_cycles += oldest->ready - t;
+		clock->stall(oldest->ready - t);
+		t = oldest->ready;
+	}
+	oldest->line = line;
+	oldest->ready = t + latency;
+	if (oldest->ready > last_ready)
+		last_ready = oldest->ready;
+}
+
+void ac_cache_mshr::prefetch(uint32_t line)
+{
+	uint64_t t = clock->now();
+	entry *free_entry = NULL;
+
+	for (size_t i = 0; i < entries.size(); i++) {
+		if (entries[i].ready <= t)
+			free_entry = &entries[i];
+		else if (entries[i].line == line)
+			return;
+	}
+	if (!free_entry)
+		return;
+	free_entry->line = line;
+	free_entry->ready = t + latency;
+	if (free_entry->ready > last_ready)
+		last_ready = free_entry->ready;
+}
+
+void ac_cache_mshr::print(std::ostream &out) const
+{
+	if (!active())
+		return;
+
+	out << "Non-blocking: " << entries.size() << " MSHRs, " << latency
+	    << " cycle misses" << std::endl;
+	out << "Misses: " << primary << " primary, " << merged
+	    << " merged into outstanding ones" << std::endl;
+	out << "Stalls: " << data_stalls << " waiting for data (" << data_stall_cycles
+	    << " cycles), " << full_stalls << " waiting for an MSHR ("
+	    << full_stall_cycles << " cycles)" << std::endl;
+}
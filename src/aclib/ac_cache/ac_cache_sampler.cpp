@@ -0,0 +1,86 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ac_cache_sampler.H"
+
+void ac_cache_sampler::configure(unsigned sets, unsigned r)
+{
+	if (r <= 1 || sets <= 1) {
+		ratio = 1;
+		slot.clear();
+		counts.clear();
+		return;
+	}
+	if ((r & (r-1)) || r > sets) {
+		fprintf(stderr, "ArchC: cache sampling ratio must be a power of 2 no larger than %u.\n", sets);
+		exit(EXIT_FAILURE);
+	}
+
+	unsigned set_bits = 0, ratio_bits = 0;
+	while ((1u << set_bits) < sets) set_bits++;
+	while ((1u << ratio_bits) < r) ratio_bits++;
+
+	// an odd multiplier permutes the set numbers; the sets whose
+	// permuted number has its top ratio_bits clear are sampled
+	ratio = r;
+	slot.assign(sets, -1);
+	counts.clear();
+	for (unsigned s = 0; s < sets; s++) {
+		unsigned h = (s * 0x9e3779b1u) & (sets - 1);
+		if ((h >> (set_bits - ratio_bits)) == 0) {
+			slot[s] = counts.size();
+			counts.push_back(set_counts());
+		}
+	}
+	bypass_reads = bypass_writes = 0;
+}
+
+void ac_cache_sampler::estimate(bool write, double &rate, double &half_width) const
+{
+	double n = 0, m = 0;
+	size_t k = counts.size();
+
+	for (size_t i = 0; i < k; i++) {
+		n += write ? counts[i].writes : counts[i].reads;
+		m += write ? counts[i].write_misses : counts[i].read_misses;
+	}
+	rate = n ? m / n : 0;
+	half_width = 0;
+	if (k < 2 || n == 0)
+		return;
+
+	// Var(r) = (1 - f) / (k nbar^2) * sum((m_i - r n_i)^2) / (k - 1)
+	double sum = 0;
+	for (size_t i = 0; i < k; i++) {
+		double ni = write ? counts[i].writes : counts[i].reads;
+		double mi = write ? counts[i].write_misses : counts[i].read_misses;
+		sum += (mi - rate * ni) * (mi - rate * ni);
+	}
+	double nbar = n / k;
+	double var = (1.0 - 1.0 / ratio) * sum / ((k - 1) * k * nbar * nbar);
+	half_width = 1.96 * sqrt(var);
+}
+
+void ac_cache_sampler::print(std::ostream &out) const
+{
+	if (!active())
+		return;
+
+	unsigned long long reads = bypass_reads, writes = bypass_writes;
+	for (size_t i = 0; i < counts.size(); i++) {
+		reads += counts[i].reads;
+		writes += counts[i].writes;
+	}
+
+	double r, rh, w, wh;
+	estimate(false, r, rh);
+	estimate(true, w, wh);
+
+	out << "Set sampling: 1 in " << ratio << " sets (" << counts.size()
+	    << " simulated), estimates with 95% confidence:" << std::endl;
+	out << "Read:   miss ratio " << r*100 << "% +/- " << rh*100 << "%, ~"
+	    << (unsigned long long)(r * reads + 0.5) << " misses in " << reads << " reads" << std::endl;
+	out << "Write:  miss ratio " << w*100 << "% +/- " << wh*100 << "%, ~"
+	    << (unsigned long long)(w * writes + 0.5) << " misses in " << writes << " writes" << std::endl;
+}
@@ -1,12 +1,207 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "ac_cache_trace.H"
 
-ac_cache_trace::ac_cache_trace(std::ostream &o) : out(o) 
+/*
+ * Binary trace layout
+ *
+ *   header:  "ACTRACE" followed by a version byte (1)
+ *   blocks:  raw length (u32 LE), stored length (u32 LE), stored bytes
+ *
+ * A block is stored compressed when its stored length is smaller than its
+ * raw length. Compression is a byte-oriented LZ77 using LZ4's sequence
+ * layout (token, literals, 16-bit offset, match length extension).
+ *
+ * Raw block contents are records, never split across blocks:
+ *
+ *   byte 0   bit 0     operation (0 read, 1 write)
+ *            bits 1-3  log2 of the length, or 7 if the length follows
+ *            bits 4-7  zigzag address delta, or 15 if the delta follows
+ *   varint   zigzag address delta (if escaped)
+ *   varint   length (if escaped)
+ *
+ * The address delta is relative to the previous record in the same block,
+ * the first record of a block being relative to zero.
+ */
+
+static const char trace_magic[8] = { 'A', 'C', 'T', 'R', 'A', 'C', 'E', 1 };
+
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 14
+
+static inline uint32_t read32(const uint8_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+static inline uint32_t lz_hash(uint32_t v)
+{
+	return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static inline uint8_t *lz_put_length(uint8_t *op, unsigned l)
+{
+	for (; l >= 255; l -= 255)
+		*op++ = 255;
+	*op++ = l;
+	return op;
+}
+
+// Returns the compressed size, or 0 if it would not fit in 'limit' bytes.
+static unsigned lz_compress(const uint8_t *in, unsigned n, uint8_t *out,
+                            unsigned limit, uint32_t *table)
+{
+	const uint8_t *anchor = in, *ip = in, *end = in + n;
+	uint8_t *op = out, *oend = out + limit;
+
+	for (unsigned i = 0; i < (1u << LZ_HASH_BITS); i++)
+		table[i] = ~0u;
+
+	while (n >= LZ_MIN_MATCH && ip <= end - LZ_MIN_MATCH) {
+		uint32_t seq = read32(ip);
+		uint32_t h = lz_hash(seq);
+		uint32_t ref = table[h];
+		table[h] = ip - in;
+
+		if (ref == ~0u || (ip - in) - ref > 0xffff || read32(in + ref) != seq) {
+			ip++;
+			continue;
+		}
+
+		const uint8_t *match = in + ref;
+		unsigned mlen = LZ_MIN_MATCH;
+		while (ip + mlen < end && match[mlen] == ip[mlen])
+			mlen++;
+
+		unsigned lit = ip - anchor;
+		if (op + 1 + lit/255 + 1 + lit + 2 + mlen/255 + 1 > oend)
+			return 0;
+		uint8_t *token = op++;
+		*token = ((lit < 15 ? lit : 15) << 4) |
+		         (mlen - LZ_MIN_MATCH < 15 ? mlen - LZ_MIN_MATCH : 15);
+		if (lit >= 15)
+			op = lz_put_length(op, lit - 15);
+		memcpy(op, anchor, lit);
+		op += lit;
+		*op++ = (ip - match) & 0xff;
+		*op++ = (ip - match) >> 8;
+		if (mlen - LZ_MIN_MATCH >= 15)
+			op = lz_put_length(op, mlen - LZ_MIN_MATCH - 15);
+
+		ip += mlen;
+		anchor = ip;
+	}
+
+	// last literals, with no match following
+	unsigned lit = end - anchor;
+	if (op + 1 + lit/255 + 1 + lit > oend)
+		return 0;
+	*op++ = (lit < 15 ? lit : 15) << 4;
+	if (lit >= 15)
+		op = lz_put_length(op, lit - 15);
+	memcpy(op, anchor, lit);
+	op += lit;
+
+	return op - out;
+}
+
+// Returns false if the input is malformed or does not decode to 'n' bytes.
+static bool lz_decompress(const uint8_t *in, unsigned size, uint8_t *out, unsigned n)
+{
+	const uint8_t *ip = in, *iend = in + size;
+	uint8_t *op = out, *oend = out + n;
+
+	while (ip < iend) {
+		unsigned token = *ip++;
+		unsigned lit = token >> 4;
+		if (lit == 15) {
+			unsigned b;
+			do {
+				if (ip >= iend) return false;
+				b = *ip++;
+				lit += b;
+			} while (b == 255);
+		}
+		if (lit > (unsigned)(iend - ip) || lit > (unsigned)(oend - op))
+			return false;
+		memcpy(op, ip, lit);
+		ip += lit;
+		op += lit;
+		if (ip == iend)
+			break;
+
+		if (iend - ip < 2) return false;
+		unsigned offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		unsigned mlen = (token & 15);
+		if (mlen == 15) {
+			unsigned b;
+			do {
+				if (ip >= iend) return false;
+				b = *ip++;
+				mlen += b;
+			} while (b == 255);
+		}
+		mlen += LZ_MIN_MATCH;
+		if (offset == 0 || offset > (unsigned)(op - out) || mlen > (unsigned)(oend - op))
+			return false;
+		// byte copy, matches may overlap their own output
+		const uint8_t *match = op - offset;
+		while (mlen--)
+			*op++ = *match++;
+	}
+	return op == oend;
+}
+
+static inline void put32(uint8_t *p, uint32_t v)
+{
+	p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static inline uint32_t get32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/*
+ * ac_cache_trace
+ */
+
+ac_cache_trace::ac_cache_trace(std::ostream &o, trace_format f) :
+	out(o), format(f), head(0), tail(0), pending(0), done(false),
+	cur(NULL), fill(0), last(0)
+{
+	if (format == trace_text) {
+		out << std::hex;
+		return;
+	}
+
+	out.write(trace_magic, sizeof(trace_magic));
+	for (unsigned i = 0; i < AC_TRACE_BLOCKS; i++)
+		blocks[i].resize(AC_TRACE_BLOCK_SIZE);
+	cur = blocks[head].data();
+	writer = std::thread(&ac_cache_trace::write_blocks, this);
+}
+
+ac_cache_trace::~ac_cache_trace()
 {
-	out << std::hex;
+	if (format != trace_text) {
+		flush_block();
+		{
+			std::lock_guard<std::mutex> g(lock);
+			done = true;
+		}
+		ready.notify_one();
+		writer.join();
+	}
+	out.flush();
 }
-ac_cache_trace::~ac_cache_trace() { out.flush(); }
 
-void ac_cache_trace::add(trace_operation o, unsigned a, unsigned l)
+void ac_cache_trace::add_text(trace_operation o, unsigned a, unsigned l)
 {
 	if (o == trace_read) {
 		out << "r ";
@@ -17,3 +212,157 @@ void ac_cache_trace::add(trace_operation o, unsigned a, unsigned l)
 	out << a << " " << l << '\n';
 }
 
+// Hands the current block to the writer thread and moves to the next one,
+// waiting only when the writer is a full ring behind.
+void ac_cache_trace::flush_block()
+{
+	if (fill == 0)
+		return;
+
+	std::unique_lock<std::mutex> g(lock);
+	block_fill[head] = fill;
+	pending++;
+	ready.notify_one();
+	head = (head + 1) % AC_TRACE_BLOCKS;
+	drained.wait(g, [this] { return pending < AC_TRACE_BLOCKS; });
+
+	cur = blocks[head].data();
+	fill = 0;
+	last = 0;
+}
+
+// Writer thread: compresses (if asked to) and writes out full blocks.
+void ac_cache_trace::write_blocks()
+{
+	std::vector<uint8_t> packed;
+	std::vector<uint32_t> table;
+	uint8_t frame[8];
+
+	if (format == trace_binary_compressed) {
+		packed.resize(AC_TRACE_BLOCK_SIZE);
+		table.resize(1u << LZ_HASH_BITS);
+	}
+
+	std::unique_lock<std::mutex> g(lock);
+	for (;;) {
+		ready.wait(g, [this] { return pending > 0 || done; });
+		if (pending == 0)
+			break;
+		unsigned b = tail;
+		unsigned n = block_fill[b];
+		g.unlock();
+
+		const uint8_t *data = blocks[b].data();
+		unsigned stored = n;
+		if (format == trace_binary_compressed) {
+			unsigned c = lz_compress(data, n, packed.data(), n - 1, table.data());
+			if (c) {
+				data = packed.data();
+				stored = c;
+			}
+		}
+		put32(frame, n);
+		put32(frame + 4, stored);
+		out.write((const char *)frame, sizeof(frame));
+		out.write((const char *)data, stored);
+
+		g.lock();
+		tail = (tail + 1) % AC_TRACE_BLOCKS;
+		pending--;
+		drained.notify_one();
+	}
+}
+
+/*
+ * ac_cache_trace_reader
+ */
+
+static void corrupt_trace()
+{
+	fprintf(stderr, "ArchC: corrupt cache trace.\n");
+	exit(EXIT_FAILURE);
+}
+
+ac_cache_trace_reader::ac_cache_trace_reader(std::istream &i) :
+	in(i), format(trace_text), pos(0), last(0)
+{
+	char magic[sizeof(trace_magic)];
+
+	if (in.peek() != trace_magic[0])
+		return;
+	if (!in.read(magic, sizeof(magic)) || memcmp(magic, trace_magic, sizeof(magic)))
+		corrupt_trace();
+	format = trace_binary;
+}
+
+bool ac_cache_trace_reader::next_block()
+{
+	uint8_t frame[8];
+
+	if (!in.read((char *)frame, sizeof(frame)))
+		return false;
+
+	uint32_t n = get32(frame), stored = get32(frame + 4);
+	if (n == 0 || stored > n || n > AC_TRACE_BLOCK_SIZE)
+		corrupt_trace();
+
+	block.resize(n);
+	if (stored == n) {
+		if (!in.read((char *)block.data(), n))
+			corrupt_trace();
+	}
+	else {
+		format = trace_binary_compressed;
+		raw.resize(stored);
+		if (!in.read((char *)raw.data(), stored) ||
+		    !lz_decompress(raw.data(), stored, block.data(), n))
+			corrupt_trace();
+	}
+	pos = 0;
+	last = 0;
+	return true;
+}
+
+bool ac_cache_trace_reader::get_varint(uint32_t &v)
+{
+	v = 0;
+	for (unsigned shift = 0; shift < 35; shift += 7) {
+		if (pos >= block.size())
+			return false;
+		uint8_t b = block[pos++];
+		v |= (uint32_t)(b & 0x7f) << shift;
+		if (!(b & 0x80))
+			return true;
+	}
+	return false;
+}
+
+bool ac_cache_trace_reader::next(trace_operation &o, unsigned &a, unsigned &l)
+{
+	if (format == trace_text) {
+		char c;
+		if (!(in >> c >> std::hex >> a >> l))
+			return false;
+		o = (c == 'w') ? trace_write : trace_read;
+		return true;
+	}
+
+	if (pos >= block.size() && !next_block())
+		return false;
+
+	uint8_t h = block[pos++];
+	uint32_t z = h >> 4;
+	uint32_t lc = (h >> 1) & 7;
+	uint32_t len = 1u << lc;
+
+	if (z == 15 && !get_varint(z))
+		corrupt_trace();
+	if (lc == 7 && !get_varint(len))
+		corrupt_trace();
+
+	last += (z >> 1) ^ -(z & 1);
+	o = (h & 1) ? trace_write : trace_read;
+	a = last;
+	l = len;
+	return true;
+}
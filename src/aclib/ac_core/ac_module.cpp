@@ -111,6 +111,11 @@ void ac_module::set_running() {
 
 /// Public method that unregisters module (ie, it's no longer running).
 void ac_module::set_stopped() {
+#ifndef AC_STANDALONE
+  // a processor thread stops at the barrier (see ac_parallel)
+  if (ac_parallel::defer_stop(this))
+    return;
+#endif
   if (--running_mods == 0) {
     dup2(2, 1); //any output to stdout is redirected for stderr (ex. SystemC stop message)
     sc_stop();
@@ -129,6 +134,18 @@ void ac_module::set_quantum(unsigned int time_quantum_ns) {
   ac_qk.reset();
 }
 
+/// Public method that lets the quantum adapt between min_ns and max_ns
+void ac_module::set_adaptive_quantum(unsigned int min_ns, unsigned int max_ns) {
+  ac_qk.set_adaptive(sc_time(min_ns, SC_NS), sc_time(max_ns, SC_NS));
+}
+
+#ifdef AC_STANDALONE
+/// Public method that runs the module until it stops.
+void ac_module::run() {
+  behavior();
+}
+#endif
+
 /// Public method that sets the processor frequency(MHz to ns) 
 void ac_module::set_proc_freq(unsigned int proc_freq_mhz) {
   module_period_ns=1000/proc_freq_mhz;
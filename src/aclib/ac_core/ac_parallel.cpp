@@ -0,0 +1,472 @@
+/**
+ * @file      ac_parallel.cpp
+ *
+ *            The ArchC Team
+ *            http://www.archc.org/
+ *
+ *            Computer Systems Laboratory (LSC)
+ *            IC-UNICAMP
+ *            http://www.lsc.ic.unicamp.br/
+ *
+ * @brief     Implementation of the parallel execution of ArchC processors.
+ *
+ * @attention Copyright (C) 2002-2006 --- The ArchC Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+//////////////////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// SystemC includes
+
+// ArchC includes
+#include "ac_parallel.H"
+#include "ac_module.H"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// Bytes stored by a processor in the current quantum, per 4-byte chunk.
+struct store_chunk {
+  uint8_t data[4];
+  uint8_t mask;
+};
+
+enum core_state {
+  RUNNING,     // executing on its host thread
+  AT_BARRIER,  // done with the quantum
+  REQUEST,     // waiting for its turn (see request_kind)
+  TURN_DONE,   // leaving an exclusive section
+  DONE         // behavior returned
+};
+
+enum request_kind { SERIAL, EXCLUSIVE, LOCK, UNLOCK };
+
+/// A processor run by ac_parallel.
+struct core {
+  ac_module *mod;
+  std::function<void()> body;
+  std::thread thread;
+  core_state state;
+  bool go;                          // resumes the thread
+  bool stop_pending;                // stop() was called on the thread
+  request_kind kind;
+  const std::function<void()> *fn;  // SERIAL
+  const void *owner;                // LOCK and UNLOCK
+  std::unordered_map<uintptr_t, store_chunk> log;
+};
+
+// Guards the state of the cores; the rest is only touched by SystemC
+std::mutex mtx;
+std::condition_variable driver_cv, cores_cv;
+
+std::vector<core*> cores;
+bool started = false;
+thread_local core *current = NULL;
+
+const void *lock_owner = NULL;
+unsigned lock_depth = 0;
+
+// Processor in an exclusive section: only its requests are served
+core *exclusive_owner = NULL;
+
+sc_event &lock_released()
+{
+  static sc_event e;
+  return e;
+}
+
+bool by_mod_id(const core *a, const core *b)
+{
+  return a->mod->mod_id < b->mod->mod_id;
+}
+
+void wait_go(core *c, std::unique_lock<std::mutex> &l)
+{
+  while (!c->go)
+    cores_cv.wait(l);
+  c->go = false;
+}
+
+/// Stops the calling processor in state s until the driver resumes it.
+void park(core *c, core_state s)
+{
+  std::unique_lock<std::mutex> l(mtx);
+  c->state = s;
+  driver_cv.notify_one();
+  wait_go(c, l);
+}
+
+void resume(core *c)
+{
+  c->state = RUNNING;
+  c->go = true;
+}
+
+void thread_main(core *c)
+{
+  current = c;
+  {
+    std::unique_lock<std::mutex> l(mtx);
+    wait_go(c, l);
+  }
+  c->body();
+  std::unique_lock<std::mutex> l(mtx);
+  c->state = DONE;
+  driver_cv.notify_one();
+}
+
+/// Copies the stores of c to memory.
+void commit(core *c)
+{
+  std::unordered_map<uintptr_t, store_chunk>::const_iterator i;
+
+  for (i = c->log.begin(); i != c->log.end(); i++) {
+    uint8_t *p = (uint8_t*) (i->first << 2);
+    for (unsigned b = 0; b < 4; b++)
+      if (i->second.mask & (1 << b))
+        p[b] = i->second.data[b];
+  }
+  c->log.clear();
+}
+
+void release(const void *owner)
+{
+  if (owner == lock_owner && --lock_depth == 0) {
+    lock_owner = NULL;
+    lock_released().notify(SC_ZERO_TIME);
+  }
+}
+
+/// Waits until no processor is running.
+void wait_parked(std::unique_lock<std::mutex> &l)
+{
+  std::vector<core*>::iterator i;
+
+  for (i = cores.begin(); i != cores.end(); ) {
+    if ((*i)->state == RUNNING) {
+      driver_cv.wait(l);
+      i = cores.begin();
+    }
+    else
+      i++;
+  }
+}
+
+/// Serves the requests of the parked processors in processor order and
+/// resumes them; false when none could be served.
+bool serve(std::unique_lock<std::mutex> &l)
+{
+  std::vector<core*> resumed;
+  std::vector<core*>::iterator i;
+  bool served = false;
+
+  // a processor stopping or reaching the barrier leaves its section
+  if (exclusive_owner != NULL &&
+      (exclusive_owner->state == DONE || exclusive_owner->state == AT_BARRIER))
+    exclusive_owner = NULL;
+
+  for (i = cores.begin(); i != cores.end(); i++) {
+    core *c = *i;
+
+    if (exclusive_owner != NULL && c != exclusive_owner)
+      continue;
+    if (c->state == TURN_DONE) {
+      exclusive_owner = NULL;
+      served = true;
+      resumed.push_back(c);
+      continue;
+    }
+    if (c->state != REQUEST)
+      continue;
+    if (c->kind == LOCK && lock_owner != NULL && lock_owner != c->owner)
+      continue;
+    // the processors served so far run before the section
+    if (c->kind == EXCLUSIVE && !resumed.empty())
+      break;
+
+    // what the processor stored so far becomes visible to the request
+    commit(c);
+    served = true;
+    switch (c->kind) {
+    case SERIAL:
+      l.unlock();
+      (*c->fn)();
+      l.lock();
+      break;
+    case EXCLUSIVE:
+      // the section runs alone; what it requests is served in the next
+      // rounds, until end_exclusive()
+      exclusive_owner = c;
+      resume(c);
+      cores_cv.notify_all();
+      return true;
+    case LOCK:
+      lock_owner = c->owner;
+      lock_depth++;
+      break;
+    case UNLOCK:
+      release(c->owner);
+      break;
+    }
+    resumed.push_back(c);
+  }
+
+  for (i = resumed.begin(); i != resumed.end(); i++)
+    resume(*i);
+  cores_cv.notify_all();
+  return served;
+}
+
+/// Runs quanta until every processor stops.
+void drive()
+{
+  std::unique_lock<std::mutex> l(mtx);
+  std::vector<core*>::iterator i;
+
+  for (;;) {
+    for (i = cores.begin(); i != cores.end(); i++)
+      if ((*i)->state == AT_BARRIER)
+        resume(*i);
+    cores_cv.notify_all();
+
+    do
+      wait_parked(l);
+    while (serve(l));
+
+    // the barrier: SystemC catches up with the furthest processor
+    sc_time step = SC_ZERO_TIME;
+    bool live = false;
+    for (i = cores.begin(); i != cores.end(); i++) {
+      core *c = *i;
+
+      commit(c);
+      if (c->state == DONE) {
+        if (c->stop_pending) {
+          c->stop_pending = false;
+          l.unlock();
+          c->mod->set_stopped();
+          l.lock();
+        }
+        continue;
+      }
+      live = true;
+      if (c->mod->ac_qk.get_local_time() > step)
+        step = c->mod->ac_qk.get_local_time();
+      c->mod->ac_qk.synced();
+    }
+    if (!live)
+      return;
+
+    if (step == SC_ZERO_TIME)
+      step = tlm::tlm_global_quantum::instance().get();
+    l.unlock();
+    wait(step);
+    l.lock();
+    for (i = cores.begin(); i != cores.end(); i++)
+      if ((*i)->state != DONE)
+        (*i)->mod->ac_qk.reset();
+  }
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Runs body, the behavior of module m, on a host thread.
+void ac_parallel::run(ac_module *m, std::function<void()> body)
+{
+  std::vector<core*>::iterator i;
+
+  if (started) {
+    fprintf(stderr, "ArchC: %s: processors running in parallel must start in the first delta cycle.\n",
+            m->name());
+    exit(EXIT_FAILURE);
+  }
+
+  core *c = new core();
+  c->mod = m;
+  c->body = body;
+  c->state = AT_BARRIER;
+  cores.push_back(c);
+  m->ac_qk.reset();
+  if (cores.size() > 1)
+    return;
+
+  // every processor registers in this delta cycle
+  wait(SC_ZERO_TIME);
+  started = true;
+  std::sort(cores.begin(), cores.end(), by_mod_id);
+  for (i = cores.begin(); i != cores.end(); i++)
+    (*i)->thread = std::thread(thread_main, *i);
+
+  drive();
+
+  for (i = cores.begin(); i != cores.end(); i++) {
+    (*i)->thread.join();
+    delete *i;
+  }
+  cores.clear();
+  started = false;
+}
+
+/// True on a processor thread.
+bool ac_parallel::on_host_thread()
+{
+  return current != NULL;
+}
+
+/// Quantum synchronization.
+void ac_parallel::sync(tlm_utils::tlm_quantumkeeper &qk)
+{
+  if (current != NULL)
+    park(current, AT_BARRIER);
+  else
+    qk.sync();
+}
+
+/// Sleeps until the end of the quantum.
+void ac_parallel::idle(tlm_utils::tlm_quantumkeeper &qk)
+{
+  qk.inc(tlm::tlm_global_quantum::instance().get());
+  sync(qk);
+}
+
+/// Runs f on the SystemC side once every processor is parked.
+void ac_parallel::serial(const std::function<void()> &f)
+{
+  if (current == NULL) {
+    f();
+    return;
+  }
+  current->kind = SERIAL;
+  current->fn = &f;
+  park(current, REQUEST);
+}
+
+/// Starts a section run while every other processor is parked.
+void ac_parallel::begin_exclusive()
+{
+  if (current == NULL)
+    return;
+  current->kind = EXCLUSIVE;
+  park(current, REQUEST);
+}
+
+/// Ends a section started by begin_exclusive().
+void ac_parallel::end_exclusive()
+{
+  if (current != NULL)
+    park(current, TURN_DONE);
+}
+
+/// Takes the device lock for owner.
+void ac_parallel::lock(const void *owner)
+{
+  if (current != NULL) {
+    current->kind = LOCK;
+    current->owner = owner;
+    park(current, REQUEST);
+    return;
+  }
+  while (lock_owner != NULL && lock_owner != owner)
+    wait(lock_released());
+  lock_owner = owner;
+  lock_depth++;
+}
+
+/// Releases the device lock held by owner.
+void ac_parallel::unlock(const void *owner)
+{
+  if (current != NULL) {
+    current->kind = UNLOCK;
+    current->owner = owner;
+    park(current, REQUEST);
+    return;
+  }
+  release(owner);
+}
+
+/// Reads host memory, seeing the stores of the calling processor.
+void ac_parallel::read(void *buf, const uint8_t *mem, unsigned length)
+{
+  core *c = current;
+  uint8_t *out = (uint8_t*) buf;
+
+  if (c == NULL || c->log.empty()) {
+    memcpy(buf, mem, length);
+    return;
+  }
+  for (unsigned i = 0; i < length; ) {
+    uintptr_t a = (uintptr_t) (mem + i);
+    std::unordered_map<uintptr_t, store_chunk>::const_iterator e = c->log.find(a >> 2);
+    do {
+      if (e != c->log.end() && (e->second.mask & (1 << (a & 3))))
+        out[i] = e->second.data[a & 3];
+      else
+        out[i] = mem[i];
+      i++, a++;
+    } while (i < length && (a & 3));
+  }
+}
+
+/// Writes host memory, through the store log on processor threads.
+void ac_parallel::write(uint8_t *mem, const void *buf, unsigned length)
+{
+  core *c = current;
+  const uint8_t *in = (const uint8_t*) buf;
+
+  if (c == NULL) {
+    memcpy(mem, buf, length);
+    return;
+  }
+  for (unsigned i = 0; i < length; ) {
+    uintptr_t a = (uintptr_t) (mem + i);
+    store_chunk &s = c->log[a >> 2];
+    do {
+      s.data[a & 3] = in[i];
+      s.mask |= 1 << (a & 3);
+      i++, a++;
+    } while (i < length && (a & 3));
+  }
+}
+
+/// Defers the stop of a module running on a processor thread.
+bool ac_parallel::defer_stop(ac_module *m)
+{
+  std::vector<core*>::iterator i;
+
+  if (current == NULL)
+    return false;
+  for (i = cores.begin(); i != cores.end(); i++)
+    if ((*i)->mod == m) {
+      (*i)->stop_pending = true;
+      return true;
+    }
+  return false;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file      ac_quantumkeeper.cpp
+ *
+ *            The ArchC Team
+ *            http://www.archc.org/
+ *
+ *            Computer Systems Laboratory (LSC)
+ *            IC-UNICAMP
+ *            http://www.lsc.ic.unicamp.br/
+ *
+ * @brief     Implementation of the quantum keeper of ArchC modules.
+ *
+ * @attention Copyright (C) 2002-2006 --- The ArchC Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+//////////////////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// SystemC includes
+
+// ArchC includes
+#include "ac_quantumkeeper.H"
+
+//////////////////////////////////////////////////////////////////////////////
+
+ac_quantumkeeper::ac_quantumkeeper() : adaptive(false), interacted(false),
+                                       syncs(0), interactions(0), first_sync(0)
+{
+}
+
+/// Lets the quantum float from min to max.
+void ac_quantumkeeper::set_adaptive(const sc_time &min, const sc_time &max)
+{
+  if (min == SC_ZERO_TIME || max < min) {
+    fprintf(stderr, "ArchC: invalid adaptive quantum bounds.\n");
+    exit(EXIT_FAILURE);
+  }
+  adaptive = true;
+  min_quantum = min;
+  max_quantum = max;
+  quantum = min;
+  reset();
+}
+
+/// Halves the quantum at an interaction with the rest of the platform.
+void ac_quantumkeeper::interaction()
+{
+  interactions++;
+  if (!adaptive)
+    return;
+
+  interacted = true;
+  quantum = quantum / 2;
+  if (quantum < min_quantum)
+    quantum = min_quantum;
+
+  // the current quantum ends within the shrunk one
+  sc_time end = sc_time_stamp() + m_local_time + quantum;
+  if (end < m_next_sync_point)
+    m_next_sync_point = end;
+}
+
+/// Accounts for a sync at the current local time.
+void ac_quantumkeeper::synced()
+{
+  if (syncs++ == 0)
+    first_sync = times(&host_times);
+  synced_time += m_local_time;
+
+  // a quiet quantum lets the next one double
+  if (adaptive && !interacted) {
+    quantum = quantum * 2;
+    if (quantum > max_quantum)
+      quantum = max_quantum;
+  }
+  interacted = false;
+}
+
+void ac_quantumkeeper::sync()
+{
+  synced();
+  tlm_utils::tlm_quantumkeeper::sync();
+}
+
+sc_time ac_quantumkeeper::compute_local_quantum()
+{
+  if (adaptive)
+    return quantum;
+  return tlm_utils::tlm_quantumkeeper::compute_local_quantum();
+}
+
+/// Average simulated time between syncs.
+sc_time ac_quantumkeeper::get_average_quantum() const
+{
+  if (syncs == 0)
+    return SC_ZERO_TIME;
+  return synced_time / (double) syncs;
+}
+
+/// Syncs per second of host time, since the first one.
+double ac_quantumkeeper::get_syncs_per_second() const
+{
+  struct tms now;
+  double seconds = (double) (times(&now) - first_sync) / sysconf(_SC_CLK_TCK);
+
+  if (syncs < 2 || seconds <= 0)
+    return 0;
+  return (syncs - 1) / seconds;
+}
+
+void ac_quantumkeeper::print_statistics(std::ostream &os) const
+{
+  os << "    Quantum syncs: " << syncs;
+  if (get_syncs_per_second() > 0)
+    os << " (" << (unsigned long long) get_syncs_per_second() << " per second)";
+  os << "\n";
+  os << "    Average quantum: " << get_average_quantum() << "\n";
+  if (adaptive)
+    os << "    Interactions: " << interactions << " (quantum from "
+       << min_quantum << " to " << max_quantum << ")\n";
+}
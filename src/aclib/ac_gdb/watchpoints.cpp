@@ -0,0 +1,193 @@
+/**
+ * @file      watchpoints.cpp
+ * @author    The ArchC Team
+ *            http://www.archc.org/
+ *
+ *            Computer Systems Laboratory (LSC)
+ *            IC-UNICAMP
+ *            http://www.lsc.ic.unicamp.br/
+ *
+ * @brief     Watchpoint support
+ *            Watched ranges are flagged per guest page, so memory ports
+ *            pay a single table lookup per access and only run the
+ *            address matching below on watched pages.
+ *
+ * @attention Copyright (C) 2002-2006 --- The ArchC Team
+ * 
+ * This program is free software; you can redistribute it and/or modify 
+ * it under the terms of the GNU General Public License as published by 
+ * the Free Software Foundation; either version 2 of the License, or 
+ * (at your option) any later version. 
+ * 
+ * This program is distributed in the hope that it will be useful, 
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the 
+ * GNU General Public License for more details. 
+ * 
+ * You should have received a copy of the GNU General Public License 
+ * along with this program; if not, write to the Free Software 
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * \note When modifing this file respect:
+ * \li License
+ * \li Previous author names. Add your own after current ones.
+ * \li Coding style (basically emacs style)
+ * \li Commenting style. This code use doxygen (http://www.doxygen.org)
+ *     to be documented.
+ */
+
+#include "watchpoints.H"
+
+/**
+ * Constructor
+ *
+ * \param quant how many watchpoints to support
+ */
+Watchpoints::Watchpoints(int quant) {
+  quantMax = quant;
+  if ( ( wp = (watchpoint *) calloc( quantMax,
+				     sizeof( watchpoint ) ) ) == NULL )
+    {
+      perror( "Couldn't allocate watchpoint array." );
+      quantMax = 0;
+    }
+  this->quant = 0; /* no watchpoints at start up */
+  pages = NULL;    /* no page is watched */
+  clear_hit();
+}
+
+
+/**
+ * Destructor
+ */
+Watchpoints::~Watchpoints() {
+  if ( wp ) free( wp );
+  if ( pages ) free( pages );
+  wp = NULL;
+  pages = NULL;
+}
+
+
+/**
+ * Update the watch counters of the pages covered by a range
+ *
+ * \param address start of the range
+ * \param length range length in bytes
+ * \param delta +1 when adding a watchpoint, -1 when removing it
+ */
+void Watchpoints::mark_pages(unsigned int address, unsigned int length, int delta) {
+  unsigned int page, last;
+
+  page = address >> WATCH_PAGE_BITS;
+  last = ( address + ( length ? length - 1 : 0 ) ) >> WATCH_PAGE_BITS;
+  if ( last < page ) /* wrapped around the address space */
+    last = UINT_MAX >> WATCH_PAGE_BITS;
+
+  for ( ; page <= last; page ++ )
+    pages[ page ] += delta;
+}
+
+
+/**
+ * Add watchpoint on a range
+ *
+ * \param type WRITE, READ or ACCESS
+ * \param address start of the watched range
+ * \param length range length in bytes
+ *
+ * \return 0 on success, -1 otherwise
+ */
+int Watchpoints::add(int type, unsigned int address, unsigned int length) {
+  if ( ( ! wp ) || ( quant >= quantMax ) )
+    return -1;
+
+  if ( ! pages ) {
+    pages = (unsigned short *) calloc( ( UINT_MAX >> WATCH_PAGE_BITS ) + 1,
+                                       sizeof( unsigned short ) );
+    if ( ! pages ) {
+      perror( "Couldn't allocate watchpoint page table." );
+      return -1;
+    }
+  }
+
+  wp[ quant ].type    = type;
+  wp[ quant ].address = address;
+  wp[ quant ].length  = length;
+  quant ++;
+
+  mark_pages( address, length, 1 );
+  return 0;
+}
+
+
+/**
+ * Remove watchpoint from a range
+ *
+ * \param type WRITE, READ or ACCESS
+ * \param address start of the watched range
+ * \param length range length in bytes
+ *
+ * \return 0 on success, -1 otherwise
+ */
+int Watchpoints::remove(int type, unsigned int address, unsigned int length) {
+  int i;
+
+  if ( ! wp )
+    return -1;
+
+  for ( i = 0; i < quant; i ++ )
+    if ( ( wp[ i ].type == type ) && ( wp[ i ].address == address ) &&
+         ( wp[ i ].length == length ) )
+      {
+	mark_pages( address, length, -1 );
+
+	/* Move the last watchpoint into the hole: order does not matter */
+	wp[ i ] = wp[ -- quant ];
+	return 0;
+      }
+
+  return -1;
+}
+
+
+/**
+ * Match an access to a watched page against the watched ranges
+ *
+ * \param address access address
+ * \param length access size in bytes
+ * \param is_write non-zero for stores
+ *
+ * \return 1 if a watchpoint was hit, 0 otherwise
+ */
+int Watchpoints::check(unsigned int address, unsigned int length, int is_write) {
+  int i;
+
+  for ( i = 0; i < quant; i ++ ) {
+    if ( ( wp[ i ].type == WRITE && ! is_write ) ||
+         ( wp[ i ].type == READ && is_write ) )
+      continue;
+
+    /* [address, address+length) overlaps [wp.address, wp.address+wp.length) */
+    if ( ( address - wp[ i ].address < wp[ i ].length ) ||
+         ( wp[ i ].address - address < length ) )
+      {
+	/* Keep the first hit until GDB is told about it */
+	if ( ! hit_type ) {
+	  hit_type = wp[ i ].type;
+	  hit_addr = ( address < wp[ i ].address ) ? wp[ i ].address : address;
+	}
+	return 1;
+      }
+  }
+
+  return 0;
+}
+
+
+/**
+ * Forget the last hit
+ */
+void Watchpoints::clear_hit() {
+  hit_type = 0;
+  hit_addr = 0;
+}
@@ -167,8 +167,6 @@ namespace ac_dynlink {
   /* Loads the dynamic table. Needs the DYNAMIC segment address */
   void dynamic_info::load_dynamic_info (Elf32_Addr addr, unsigned char *mem, bool match_endian) {
     Elf32_Dyn *buffer;
-    Elf32_Dyn *entry;
-    unsigned int i;
     
     this->match_endian = match_endian;
     
@@ -180,12 +178,10 @@ namespace ac_dynlink {
     
     dynamic_segment = new Elf32_Dyn[dynamic_size];
     
-    for (i = 0, entry = dynamic_segment;
-	 i < dynamic_size;
-	 i++, entry++) {
-      entry->d_tag = convert_endian(4, buffer[i].d_tag, match_endian);
-      entry->d_un.d_val = convert_endian(4, buffer[i].d_un.d_val, match_endian);
-    }
+    if (match_endian)
+      memcpy(dynamic_segment, buffer, dynamic_size * sizeof(Elf32_Dyn));
+    else
+      ac_block_swap(dynamic_segment, buffer, dynamic_size * sizeof(Elf32_Dyn), 4);
   }
 
   /* Load needed shared libraries, as indicated in DT_NEEDED tags */
@@ -260,7 +256,9 @@ old and can't be used (version mismatch).\n");
       return EXIT_FAILURE;
     }
     
-    if (convert_endian(2,ehdr.e_type, match_endian) != ET_DYN) {
+    ac_elf_to_host(ehdr, match_endian);
+
+    if (ehdr.e_type != ET_DYN) {
       AC_ERROR("Run-time dynamic linker: File \"" << soname << "\" is not an ELF dynamic library.");
       exit(EXIT_FAILURE);
     }
@@ -273,31 +271,32 @@ old and can't be used (version mismatch).\n");
 #endif
     
     //Get program headers and load segments
-    for (i=0; i<convert_endian(2,ehdr.e_phnum, match_endian); i++) {
+    for (i=0; i<ehdr.e_phnum; i++) {
       unsigned int segment_type;
       
       //Get program headers and load segments
-      lseek(fd, convert_endian(4,ehdr.e_phoff, match_endian) + convert_endian(2,ehdr.e_phentsize, match_endian) * i, SEEK_SET);
+      lseek(fd, ehdr.e_phoff + ehdr.e_phentsize * i, SEEK_SET);
       if (read(fd, &phdr, sizeof(phdr)) != sizeof(phdr)) {
 	AC_ERROR("reading ELF program header.");
 	close(fd);
 	exit(EXIT_FAILURE);
       }
+      ac_elf_to_host(phdr, match_endian);
       
-      segment_type = convert_endian(4, phdr.p_type, match_endian);
+      segment_type = phdr.p_type;
       
       switch(segment_type) {
       case PT_INTERP:
 	break;
       case PT_DYNAMIC:  // Dynamic information
-	dyn_addr = load_addr + convert_endian(4, phdr.p_vaddr, match_endian);
-	dyn_size = convert_endian(4, phdr.p_memsz, match_endian);
+	dyn_addr = load_addr + phdr.p_vaddr;
+	dyn_size = phdr.p_memsz;
 	/* Fall through. */
       case PT_LOAD: { // Loadable segment type - load dynamic segments as well
-	Elf32_Addr p_vaddr = convert_endian(4,phdr.p_vaddr, match_endian);
-	Elf32_Word p_memsz = convert_endian(4,phdr.p_memsz, match_endian);
-	Elf32_Word p_filesz = convert_endian(4,phdr.p_filesz, match_endian);
-	Elf32_Off  p_offset = convert_endian(4,phdr.p_offset, match_endian);
+	Elf32_Addr p_vaddr = phdr.p_vaddr;
+	Elf32_Word p_memsz = phdr.p_memsz;
+	Elf32_Word p_filesz = phdr.p_filesz;
+	Elf32_Off  p_offset = phdr.p_offset;
 	
 	//Error if segment greater then memory
 	if (mem_size < p_vaddr + p_memsz + load_addr) {
@@ -0,0 +1,88 @@
+/**
+ * @file      systemc.h
+ *
+ *            The ArchC Team
+ *            http://www.archc.org/
+ *
+ *            Computer Systems Laboratory (LSC)
+ *            IC-UNICAMP
+ *            http://www.lsc.ic.unicamp.br/
+ *
+ * @brief     systemc.h for standalone simulators (acsim --standalone):
+ *            the SystemC stand-ins of <systemc> and the names systemc.h
+ *            brings to the global namespace.
+ *
+ * @attention Copyright (C) 2002-2006 --- The ArchC Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _AC_STANDALONE_SYSTEMC_H_
+#define _AC_STANDALONE_SYSTEMC_H_
+
+//////////////////////////////////////////////////////////////////////////////
+
+// Standard includes
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// SystemC includes
+#include "systemc"
+
+//////////////////////////////////////////////////////////////////////////////
+
+using namespace sc_core;
+
+using std::ios;
+using std::streambuf;
+using std::streampos;
+using std::streamsize;
+using std::iostream;
+using std::istream;
+using std::ostream;
+using std::fstream;
+using std::ifstream;
+using std::ofstream;
+using std::stringstream;
+using std::istringstream;
+using std::ostringstream;
+using std::cin;
+using std::cout;
+using std::cerr;
+using std::clog;
+using std::endl;
+using std::ends;
+using std::flush;
+using std::dec;
+using std::hex;
+using std::oct;
+using std::setw;
+using std::setfill;
+using std::setprecision;
+using std::setbase;
+
+//////////////////////////////////////////////////////////////////////////////
+
+#endif // _AC_STANDALONE_SYSTEMC_H_
@@ -0,0 +1,127 @@
+/**
+ * @file      tlm_quantumkeeper.h
+ *
+ *            The ArchC Team
+ *            http://www.archc.org/
+ *
+ *            Computer Systems Laboratory (LSC)
+ *            IC-UNICAMP
+ *            http://www.lsc.ic.unicamp.br/
+ *
+ * @brief     TLM-2.0 quantum keeper for standalone simulators
+ *            (acsim --standalone), with the interface of the TLM one.
+ *
+ * @attention Copyright (C) 2002-2006 --- The ArchC Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _AC_STANDALONE_TLM_QUANTUMKEEPER_H_
+#define _AC_STANDALONE_TLM_QUANTUMKEEPER_H_
+
+//////////////////////////////////////////////////////////////////////////////
+
+// SystemC includes
+#include "systemc"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace tlm {
+
+/// The global quantum.
+class tlm_global_quantum {
+ public:
+  static tlm_global_quantum &instance() {
+    static tlm_global_quantum q;
+    return q;
+  }
+
+  void set(const sc_core::sc_time &t) { quantum = t; }
+  const sc_core::sc_time &get() const { return quantum; }
+
+  /// Time left to the next multiple of the global quantum.
+  sc_core::sc_time compute_local_quantum() {
+    if (quantum == sc_core::SC_ZERO_TIME)
+      return sc_core::SC_ZERO_TIME;
+    return quantum - sc_core::sc_time_stamp() % quantum;
+  }
+
+ private:
+  sc_core::sc_time quantum;
+};
+
+} // namespace tlm
+
+namespace tlm_utils {
+
+class tlm_quantumkeeper {
+ public:
+  static void set_global_quantum(const sc_core::sc_time &t) {
+    tlm::tlm_global_quantum::instance().set(t);
+  }
+
+  static const sc_core::sc_time &get_global_quantum() {
+    return tlm::tlm_global_quantum::instance().get();
+  }
+
+  tlm_quantumkeeper() {}
+  virtual ~tlm_quantumkeeper() {}
+
+  virtual void inc(const sc_core::sc_time &t) { m_local_time += t; }
+  virtual void set(const sc_core::sc_time &t) { m_local_time = t; }
+
+  virtual bool need_sync() const {
+    return sc_core::sc_time_stamp() + m_local_time >= m_next_sync_point;
+  }
+
+  virtual void sync() {
+    sc_core::wait(m_local_time);
+    reset();
+  }
+
+  void set_and_sync(const sc_core::sc_time &t) {
+    set(t);
+    if (need_sync())
+      sync();
+  }
+
+  virtual void reset() {
+    m_local_time = sc_core::SC_ZERO_TIME;
+    m_next_sync_point = sc_core::sc_time_stamp() + compute_local_quantum();
+  }
+
+  virtual sc_core::sc_time get_current_time() const {
+    return sc_core::sc_time_stamp() + m_local_time;
+  }
+
+  virtual sc_core::sc_time get_local_time() const { return m_local_time; }
+
+ protected:
+  virtual sc_core::sc_time compute_local_quantum() {
+    return tlm::tlm_global_quantum::instance().compute_local_quantum();
+  }
+
+  sc_core::sc_time m_next_sync_point;
+  sc_core::sc_time m_local_time;
+};
+
+} // namespace tlm_utils
+
+//////////////////////////////////////////////////////////////////////////////
+
+#endif // _AC_STANDALONE_TLM_QUANTUMKEEPER_H_
@@ -30,6 +30,10 @@
  *
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "ac_mem.H"
 
 // constructor
@@ -49,6 +53,30 @@ void ac_mem::set_name(string n) {
   name = n;
 }
 
+// Length in bytes of a multi-word transfer, checked against device bounds
+uint32_t ac_mem::bulk_length(uint32_t address, int wordsize, int n_words) const {
+  uint32_t length;
+
+  switch (wordsize) {
+  case 8: case 16: case 32: case 64:
+    break;
+  default: // weird size
+    return 0;
+  }
+
+  if (n_words <= 0)
+    return 0;
+
+  length = (uint32_t) n_words * (wordsize / 8);
+  if (address > size || length > size - address) {
+    fprintf(stderr, "ArchC: %s: access of %u bytes at 0x%x is beyond device size (%u bytes).\n",
+            name.c_str(), length, address, size);
+    exit(EXIT_FAILURE);
+  }
+
+  return length;
+}
+
 string ac_mem::get_name() const {
   return name;
 }
@@ -83,30 +111,10 @@ void ac_mem::read(ac_ptr buf, uint32_t address,
 
 void ac_mem::read(ac_ptr buf, uint32_t address,
 		      int wordsize, int n_words) {
-  switch (wordsize) {
-  case 8: { // unsigned char
-    for (int i = 0; i < n_words; i++)
-      (buf.ptr8)[i] = (data.ptr8)[address + i];
-    break;
-  }      
-  case 16: { // unsigned short
-    for (int i = 0; i < n_words; i++)
-      (buf.ptr16)[i] = (data.ptr16)[address / 2 + i];
-    break;
-  }
-  case 32: { // unsigned int
-    for (int i = 0; i < n_words; i++)
-      (buf.ptr32)[i] = (data.ptr32)[address / 4 + i];
-    break;
-  }
-  case 64: { // unsigned long long
-    for (int i = 0; i < n_words; i++)
-      (buf.ptr64)[i] = (data.ptr64)[address / 8 + i];
-    break;
-  }
-  default: // weird size
-    break;
-  }
+  uint32_t length = bulk_length(address, wordsize, n_words);
+
+  // Byte-addressed copy: start addresses need not be word aligned
+  memcpy(buf.ptr8, data.ptr8 + address, length);
 }
 
 void ac_mem::write(ac_ptr buf, uint32_t address,
@@ -135,30 +143,10 @@ void ac_mem::write(ac_ptr buf, uint32_t address,
 
 void ac_mem::write(ac_ptr buf, uint32_t address,
 		       int wordsize, int n_words) {
-  switch (wordsize) {
-  case 8: { // unsigned char
-    for (int i = 0; i < n_words; i++)
-      (data.ptr8)[address + i] = (buf.ptr8)[i];
-    break;
-  }
-  case 16: { // unsigned short
-    for (int i = 0; i < n_words; i++)
-      (data.ptr16)[address / 2 + i] = (buf.ptr16)[i];
-    break;
-  }
-  case 32: { // unsigned int
-    for (int i = 0; i < n_words; i++)
-      (data.ptr32)[address / 4 + i] = (buf.ptr32)[i];
-    break;
-  }
-  case 64: { // unsigned long long
-    for (int i = 0; i < n_words; i++)
-      (data.ptr64)[address / 8 + i] = (buf.ptr64)[i];
-    break;
-  }
-  default: // weird size
-    break;
-  }
+  uint32_t length = bulk_length(address, wordsize, n_words);
+
+  // Byte-addressed copy: start addresses need not be word aligned
+  memcpy(data.ptr8 + address, buf.ptr8, length);
 }
 
 // Just for TLM2 support and compatibility
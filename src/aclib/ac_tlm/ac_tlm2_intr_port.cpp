@@ -50,6 +50,7 @@ using tlm::TLM_READ_COMMAND;
  */
 ac_tlm2_intr_port::ac_tlm2_intr_port(char const* nm, ac_intr_handler& hnd) :
   handler(hnd),
+  queue(NULL),
   name(nm)
   {
     bind(*this);
@@ -85,7 +86,11 @@ void ac_tlm2_intr_port::b_transport(ac_tlm2_payload &payload, sc_core::sc_time &
   switch( command )
   {
     case TLM_WRITE_COMMAND:    
-      handler.handle(data_p,addr);       
+      interrupt();
+      if (queue)
+        queue->post(handler, data_p, addr);
+      else
+        handler.handle(data_p,addr);       
       payload.set_response_status(tlm::TLM_OK_RESPONSE);
       break;
     
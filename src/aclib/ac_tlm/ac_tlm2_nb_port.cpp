@@ -21,6 +21,7 @@
 
 
 // Standard includes
+#include <string.h>
 
 // SystemC includes
 
@@ -39,463 +40,363 @@
  * Default constructor.
  * 
  * @param size Size or address range of the element to be attached.
+ * @param max_outstanding Number of transactions allowed in flight.
  * 
  */
-ac_tlm2_nb_port::ac_tlm2_nb_port(char const* nm, uint32_t sz) : name(nm), size(sz), LOCAL_init_socket() {
+ac_tlm2_nb_port::ac_tlm2_nb_port(char const* nm, uint32_t sz, unsigned int max_outstanding) : name(nm), size(sz), LOCAL_init_socket() {
 
   LOCAL_init_socket.register_nb_transport_bw(this, &ac_tlm2_nb_port::nb_transport_bw);
-  //payload_global = new ac_tlm2_payload();
-
-}
 
+  if (max_outstanding == 0)
+    max_outstanding = 1;
 
-tlm::tlm_sync_enum  ac_tlm2_nb_port::nb_transport_bw(ac_tlm2_payload &payload, tlm::tlm_phase &phase, sc_core::sc_time &time)
-{
+  pool.reserve(max_outstanding);
+  free_list.reserve(max_outstanding);
+  in_flight.reserve(max_outstanding);
+  read_window.reserve(max_outstanding);
 
-	#ifdef debugTLM2
-	printf("\n\nNB_TRANSPORT_BW --> Processor is receiving a package");
-	#endif
+  for (unsigned int i = 0; i < max_outstanding; i++) {
+    pool.push_back(new ac_tlm2_nb_transaction(this));
+    free_list.push_back(pool.back());
+  }
+}
 
-	/******/
- 	payload_global = new ac_tlm2_payload();
- 	
 
-	unsigned char* data_pointer = payload.get_data_ptr();		 
-	payload_global->set_data_ptr(data_pointer);
-    
+/** 
+ * Memory manager hook. Called by release() once nobody holds a reference to
+ * the payload anymore; the transaction goes back to the pool.
+ * 
+ */
+void ac_tlm2_nb_port::free(ac_tlm2_payload *payload)
+{
+	ac_tlm2_nb_transaction *t = find_transaction(payload);
 
- 	payload_global->deep_copy_from(payload);
-	
- 	#ifdef debugTLM2
-	printf("\nAC_TLM2_NB_PORT NB_TRANSPORT_BW: command-->%d  data-->%d payload_global data->%d address-->%ld",payload_global->get_command(),*data_pointer,*(payload_global->get_data_ptr()),addr);        
-	printf("\nNotifying a event in BW TRANSPORT");
-        #endif
+	t->reset();
+	free_list.push_back(t);
+	slot_free.notify();
+}
 
-	this->wake_up.notify();
 
-	phase = tlm::END_RESP;
-	tlm::tlm_sync_enum status = tlm::TLM_COMPLETED;
+/** 
+ * Maps a payload back to the pooled transaction that owns it.
+ * 
+ * @return The transaction, or NULL if the payload does not belong to us.
+ */
+ac_tlm2_nb_transaction* ac_tlm2_nb_port::find_transaction(ac_tlm2_payload *payload)
+{
+	for (unsigned int i = 0; i < pool.size(); i++)
+		if (static_cast<ac_tlm2_payload*>(pool[i]) == payload)
+			return pool[i];
 
-	return status;
+	return NULL;
 }
 
 
-//////////////////////////////////////////////////////////////////////////////
 /** 
- * Reads a single word.
- * 
- * @param buf Buffer into which the word will be copied.
- * @param address Address from where the word will be read.
- * @param wordsize Word size in bits.
+ * Maps a response carried by a payload the target allocated itself to the
+ * oldest request in flight with the same command and address, so that an
+ * interconnect answering out of order still completes the right one.
  * 
+ * @return The transaction, or NULL if no request matches.
  */
-void ac_tlm2_nb_port::read(ac_ptr buf, uint32_t address, int wordsize,sc_core::sc_time &time_info,unsigned int procId)
-
+ac_tlm2_nb_transaction* ac_tlm2_nb_port::match_response(ac_tlm2_payload &payload)
 {
+	for (unsigned int i = 0; i < in_flight.size(); i++) {
+		ac_tlm2_nb_transaction *t = in_flight[i];
 
-	payload_global = new ac_tlm2_payload();
+		if (t->get_command() == payload.get_command() &&
+		    t->get_address() == payload.get_address())
+			return t;
+	}
 
-	tlm::tlm_phase phase = tlm::BEGIN_REQ;
-	tlm::tlm_sync_enum status;
+	return NULL;
+}
 
-  	//sc_core::sc_time time_info = sc_core::sc_time(0, SC_NS);
-	unsigned char p[32];
 
-	payload_global->set_command(tlm::TLM_READ_COMMAND);
-	payload_global->set_address((sc_dt::uint64)address);
-	payload_global->set_data_ptr(p);
-	
-    if (wordsize == 8) payload_global->set_data_length(sizeof(uint8_t));
-    else if (wordsize == 16) payload_global->set_data_length(sizeof(uint16_t));
-    else if (wordsize == 32) payload_global->set_data_length(sizeof(uint32_t));
-	else {
-		printf("\n\nAC_TLM2_NB_PORT READ: wordsize not implemented");
-		exit(0);
-	}
+/** 
+ * Takes a transaction from the pool, waiting for one to be released if all
+ * of them are in flight.
+ * 
+ */
+ac_tlm2_nb_transaction* ac_tlm2_nb_port::alloc_transaction()
+{
+	while (free_list.empty())
+		wait(slot_free);
 
- 	/** IMPORTANT: The procId has been stored at the streaming_width payload field just to avoid an extention, */
-    payload_global->set_streaming_width((const unsigned int)procId);
-    /**/
+	ac_tlm2_nb_transaction *t = free_list.back();
+	free_list.pop_back();
 
-	#ifdef debugTLM2 
-	printf("\n\n*******AC_TLM2_NB_PORT READ: command-->%d address-->%ld",tlm::TLM_READ_COMMAND, address);
-	#endif
+	t->done = false;
+	t->posted = false;
+	t->acquire();
+
+	return t;
+}
 
-	/**********
-	To guarantee that there are no extensions in the payload
-	**********/
-	payload_global->free_all_extensions();	
 
-	status = LOCAL_init_socket->nb_transport_fw(*payload_global, phase, time_info);
-	if(status != tlm::TLM_UPDATED)
-	{
-		printf("\nAC_TLM2_NB_PORT READ ERROR");
+/** 
+ * Fills the payload fields shared by every request.
+ * 
+ */
+void ac_tlm2_nb_port::prepare(ac_tlm2_nb_transaction *t, tlm::tlm_command cmd,
+                              uint32_t address, int wordsize, unsigned int procId)
+{
+	if (wordsize != 8 && wordsize != 16 && wordsize != 32 && wordsize != 64) {
+		printf("*** AC_TLM2_NB_PORT: wordsize-->%d not supported ****", wordsize);
 		exit(0);
 	}
 
-	/**** TENTATIVA PARA EVITAR MEMORY LEAK*/
-	delete payload_global;
-
-
-	wait(this->wake_up);
-	
-	
-	uint8_t data8;
-	uint16_t data16;
-	uint32_t data32;
-
-	   switch (wordsize) 
-	   {
-	      case 8:
-	       	data8 = *((uint8_t*)payload_global->get_data_ptr());
-		*(buf.ptr8) = ((uint8_t*)&data8)[0];
-	        #ifdef debugTLM2 
-		printf("\nAC_TLM2_NB_PORT READ: wordsize-->%d  data8-->%d data-->%d, address-->%ld",wordsize,data8,*(payload_global->get_data_ptr()),payload_global->get_address());
-		#endif
-	       	break;
-
-	      case 16:
-	      
-		data16 = *((uint16_t*)payload_global->get_data_ptr());
-		*(buf.ptr16) = ((uint16_t*)&data16)[0];
-
-	  	#ifdef debugTLM2 
-                printf("\nAC_TLM2_NB_PORT READ: wordsize-->%d  data16-->%d data-->%d, address-->%ld",wordsize,data16,*(payload_global->get_data_ptr()),payload_global->get_address());
-		#endif
-                break;
-	      case 32:
-	       
-		data32 = *((uint32_t*)payload_global->get_data_ptr());
-
-		*(buf.ptr32) = ((uint32_t*)&data32)[0];
-
-        	#ifdef debugTLM2 
-		printf("\nAC_TLM2_NB_PORT READ: wordsize-->%d  data32-->%d data-->%d, address-->%ld",wordsize,data32,*(payload_global->get_data_ptr()),payload_global->get_address());
-		#endif
-        	break;
-	      case 64:
-	      default:
-        	printf("*** AC_TLM2_NB_PORT READ: wordsize-->%d not supported ****", wordsize);
-		exit(0);
-	        break;
-	   }
+	t->set_command(cmd);
+	t->set_address((sc_dt::uint64)address);
+	t->set_data_ptr(t->data);
+	t->set_data_length(wordsize / 8);
+	t->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
 
-	
-	delete payload_global;
- 	
+	/** IMPORTANT: The procId has been stored at the streaming_width payload field just to avoid an extention, */
+	t->set_streaming_width(procId);
+	/**/
 }
 
-/* read n_words */
-
-void ac_tlm2_nb_port::read(ac_ptr buf, uint32_t address,
-                         int wordsize, int n_words,sc_core::sc_time &time_info,unsigned int procId) {
-
-	payload_global = new ac_tlm2_payload();
 
+/** 
+ * Sends a request forward without waiting for its response.
+ * 
+ */
+void ac_tlm2_nb_port::issue(ac_tlm2_nb_transaction *t, sc_core::sc_time &time_info)
+{
 	tlm::tlm_phase phase = tlm::BEGIN_REQ;
 	tlm::tlm_sync_enum status;
 
-	//sc_core::sc_time time_info = sc_core::sc_time(0, SC_NS);
-	payload_global->set_command(tlm::TLM_READ_COMMAND);
-	
-	/** IMPORTANT: The procId has been stored at the streaming_width payload field just to avoid an extention, */
-    payload_global->set_streaming_width((const unsigned int)procId);
-    /**/
-
-	unsigned char p[32];
-	int i;
-	
 	#ifdef debugTLM2 
-	printf("\n\n*******AC_TLM2_NB_PORT READ N_WORDS: wordsize--> %d command-->%d address-->%ld",wordsize,tlm::TLM_READ_COMMAND, address);
+	printf("\n\n*******AC_TLM2_NB_PORT ISSUE: command-->%d address-->%ld",t->get_command(), (long)t->get_address());
 	#endif
 
-	/**********
-	To guarantee that there are no extensions in the payload
-	**********/
-	payload_global->free_all_extensions();	
-
-
-	switch (wordsize) 
-	{
-	    case 8:
-   	       
-		for( i=0; i<n_words; i++)
-  		{	
-			payload_global->set_address(address +i);
-			payload_global->set_data_length(sizeof(uint8_t));
-			payload_global->set_data_ptr(p);
-
-			status = LOCAL_init_socket->nb_transport_fw(*payload_global, phase, time_info); 
-			if(status != tlm::TLM_UPDATED)
-			{
-				printf("\nAC_TLM2_NB_PORT n_words READ ERROR");
-				exit(0);
-			}
-			
-			/**** TENTATIVA PARA EVITAR MEMORY LEAK*/
-			delete payload_global;
-
-			wait(this->wake_up);
-			
-	
-			unsigned char* data_pointer = payload_global->get_data_ptr();		
-
-			for (int j = 0; (i < n_words) && (j < 4); j++, i++) {
-				(buf.ptr8)[i] = ((uint8_t*)data_pointer)[j];
-			}
-			i--;
-			
-   		}
-		break;
-   
- 	  case 16:
-		for( i=0; i<n_words; i++)
-  		{
-			payload_global->set_address(address + (i * sizeof(uint16_t)));
-			payload_global->set_data_length(sizeof(uint16_t));
-			payload_global->set_data_ptr(p);
-
-			status = LOCAL_init_socket->nb_transport_fw(*payload_global, phase, time_info); 
-			if(status != tlm::TLM_UPDATED)
-			{
-				printf("\nAC_TLM2_NB_PORT n_words READ ERROR");
-				exit(0);
-			}
-
-			/**** TENTATIVA PARA EVITAR MEMORY LEAK*/
-			delete payload_global;
-
-	
-			wait(this->wake_up);
-
-    		unsigned char* data_pointer = payload_global->get_data_ptr();
-
+	in_flight.push_back(t);
 
-			for (int j = 0; (i < n_words) && (j < 4); j++, i++) {
-				buf.ptr16[i] = ((uint16_t*)data_pointer)[j];
-			}
-			i--;
+	status = LOCAL_init_socket->nb_transport_fw(*t, phase, time_info);
 
+	switch (status) {
+	case tlm::TLM_COMPLETED:
+		complete(t);
+		break;
+	case tlm::TLM_UPDATED:
+		if (phase == tlm::BEGIN_RESP) {
+			// The target answered right away: end the response ourselves
+			phase = tlm::END_RESP;
+			LOCAL_init_socket->nb_transport_fw(*t, phase, time_info);
+			complete(t);
 		}
-       		break;
-	  case 32:
-		
-		for( i=0; i<n_words; i++)
-  		{	
-			payload_global->set_address(address + (i * sizeof(uint32_t)));
-			payload_global->set_data_length(sizeof(uint32_t));
-		        payload_global->set_data_ptr(p);
-
-			status = LOCAL_init_socket->nb_transport_fw(*payload_global, phase, time_info); 
-			if(status != tlm::TLM_UPDATED)
-			{
-				printf("\nAC_TLM2_NB_PORT n_words READ ERROR");
-				exit(0);
-			}
-	
-
-			/**** TENTATIVA PARA EVITAR MEMORY LEAK*/
-			delete payload_global;
+		// On END_REQ the response will come through nb_transport_bw
+		break;
+	case tlm::TLM_ACCEPTED:
+		// Response will come through nb_transport_bw
+		break;
+	default:
+		printf("\nAC_TLM2_NB_PORT ERROR");
+		exit(0);
+	}
+}
 
 
-			wait(this->wake_up);
+/** 
+ * Marks a transaction as answered and wakes up whoever is waiting for it.
+ * 
+ */
+void ac_tlm2_nb_port::complete(ac_tlm2_nb_transaction *t)
+{
+	for (unsigned int i = 0; i < in_flight.size(); i++) {
+		if (in_flight[i] == t) {
+			in_flight.erase(in_flight.begin() + i);
+			break;
+		}
+	}
 
-			unsigned char* data_pointer = payload_global->get_data_ptr();
-			
-			buf.ptr32[i] = *((uint32_t*)data_pointer);
+	t->done = true;
 
-   		}	
-	
-	        break;
-  	  case 64:
-	  default:
-		printf("\n\nAC_TLM2_NB_PORT WRITE: wordsize not implemented");
-		exit(0);	
-		break;
-        }
-	 
-	delete payload_global;
- 		
+	if (t->posted) {
+		write_done.notify();
+		t->release();
+	}
+	else
+		t->done_event.notify();
 }
 
+
 /** 
- * Writes a single word.
+ * Blocks the calling thread until the response for @p t arrives.
  * 
- * @param buf Buffer from which the word will be copied.
- * @param address Address to where the word will be written.
- * @param wordsize Word size in bits.
- *
  */
-void ac_tlm2_nb_port::write(ac_ptr buf, uint32_t address, int wordsize,sc_core::sc_time &time_info, unsigned int procId) {
+void ac_tlm2_nb_port::wait_done(ac_tlm2_nb_transaction *t)
+{
+	while (!t->done)
+		wait(t->done_event);
+}
 
-  unsigned char p[32];
-  
-  unsigned char *ptr;
 
-  payload_global = new ac_tlm2_payload();
+/** 
+ * Checks whether a posted write to [address, address + length) is still in
+ * flight, so that a later read does not overtake it.
+ * 
+ */
+bool ac_tlm2_nb_port::write_pending(uint32_t address, unsigned int length) const
+{
+	for (unsigned int i = 0; i < in_flight.size(); i++) {
+		ac_tlm2_nb_transaction *t = in_flight[i];
+		uint32_t start = (uint32_t)t->get_address();
 
-  tlm::tlm_phase phase = tlm::BEGIN_REQ;
-  tlm::tlm_sync_enum status;
+		if (t->posted && start < address + length &&
+		    address < start + t->get_data_length())
+			return true;
+	}
 
-  //sc_core::sc_time time_info = sc_core::sc_time(0, SC_NS);
+	return false;
+}
 
 
-  #ifdef debugTLM2 
-  printf("\n\n*******AC_TLM2_NB_PORT WRITE: wordsize--> %d command-->%d address-->%ld",wordsize,tlm::TLM_WRITE_COMMAND, address);
-  #endif
+tlm::tlm_sync_enum  ac_tlm2_nb_port::nb_transport_bw(ac_tlm2_payload &payload, tlm::tlm_phase &phase, sc_core::sc_time &time)
+{
 
-   /** IMPORTANT: The procId has been stored at the streaming_width payload field just to avoid an extention, */
-   payload_global->set_streaming_width((const unsigned int)procId);
-   /**/
-	/**********
-	To guarantee that there are no extensions in the payload
-	**********/
-	payload_global->free_all_extensions();	
+	#ifdef debugTLM2
+	printf("\n\nNB_TRANSPORT_BW --> Processor is receiving a package");
+	#endif
 
+	// The request was accepted; its response comes in a later call
+	if (phase != tlm::BEGIN_RESP)
+		return tlm::TLM_ACCEPTED;
 
+	ac_tlm2_nb_transaction *t = find_transaction(&payload);
 
+	if (t == NULL) {
+		// The target answered with a payload of its own
+		t = match_response(payload);
+		if (t == NULL) {
+			printf("\nAC_TLM2_NB_PORT NB_TRANSPORT_BW: unexpected response");
+			exit(0);
+		}
 
-  switch (wordsize) {
-  case 8:
-    payload_global->set_command(tlm::TLM_READ_COMMAND);
-    payload_global->set_address((uint64_t)address);
-    payload_global->set_data_length(sizeof(uint8_t));
-    payload_global->set_data_ptr(p);
-    
-    status = LOCAL_init_socket->nb_transport_fw(*payload_global, phase, time_info); 
-    if(status != tlm::TLM_UPDATED)
-    {
-	printf("\nAC_TLM2_NB_PORT  WRITE ERROR");
-	exit(0);
-    }
-	
-    #ifdef debugTLM2 
-    printf("\n\nAC_TLM2_NB_PORT WRITE is waiting for wake_up event");
-    #endif
+		if (t->is_read())
+			memcpy(t->data, payload.get_data_ptr(), t->get_data_length());
+		t->set_response_status(payload.get_response_status());
+	}
 
-    /*****/
-    delete payload_global;
+	#ifdef debugTLM2
+	printf("\nAC_TLM2_NB_PORT NB_TRANSPORT_BW: command-->%d address-->%ld",t->get_command(),(long)t->get_address());
+	#endif
 
-    wait(this->wake_up);
+	complete(t);
 
-    
-    payload_global->set_command(tlm::TLM_WRITE_COMMAND);
+	phase = tlm::END_RESP;
+	tlm::tlm_sync_enum status = tlm::TLM_COMPLETED;
 
-    ptr = payload_global->get_data_ptr();
-    ((uint8_t*)ptr)[0] = *(buf.ptr8);
+	return status;
+}
 
-    payload_global->set_address((uint64_t)address);
-    payload_global->set_data_ptr(ptr);
 
-    
-	/**********	
-	To guarantee that there are no extensions in the payload
-	**********/
-	payload_global->free_all_extensions();	
+//////////////////////////////////////////////////////////////////////////////
+/** 
+ * Reads a single word.
+ * 
+ * @param buf Buffer into which the word will be copied.
+ * @param address Address from where the word will be read.
+ * @param wordsize Word size in bits.
+ * 
+ */
+void ac_tlm2_nb_port::read(ac_ptr buf, uint32_t address, int wordsize,sc_core::sc_time &time_info,unsigned int procId)
 
-    status =  LOCAL_init_socket->nb_transport_fw(*payload_global, phase, time_info); 
-    if(status != tlm::TLM_UPDATED)
-    {
-	printf("\nAC_TLM2_NB_PORT  WRITE ERROR");
-	exit(0);
-    }
+{
+	ac_tlm2_nb_transaction *t = alloc_transaction();
 
-	/*****/
-    delete payload_global;
+	prepare(t, tlm::TLM_READ_COMMAND, address, wordsize, procId);
 
-    wait(this->wake_up);
-    
+	while (write_pending(address, wordsize / 8))
+		wait(write_done);
 
-	
+	issue(t, time_info);
+	wait_done(t);
 
-    break;
-  case 16:
-    payload_global->set_command(tlm::TLM_READ_COMMAND);
-    payload_global->set_address((uint64_t)address);
-    payload_global->set_data_length(sizeof(uint16_t));
-    payload_global->set_data_ptr(p);
-
-    status = LOCAL_init_socket->nb_transport_fw(*payload_global, phase, time_info); 
-    if(status != tlm::TLM_UPDATED)
-    {
-	printf("\nAC_TLM2_NB_PORT  WRITE ERROR");
-	exit(0);
-    }
-	
+	memcpy(buf.ptr8, t->get_data_ptr(), wordsize / 8);
 
-	/*****/
-    delete payload_global;
+	#ifdef debugTLM2 
+	printf("\nAC_TLM2_NB_PORT READ: wordsize-->%d address-->%ld",wordsize,(long)address);
+	#endif
 
-    wait(this->wake_up);
-    
-    payload_global->set_command(tlm::TLM_WRITE_COMMAND);
-    ptr = payload_global->get_data_ptr();
+	t->release();
+}
 
-    ((uint16_t*)ptr)[0] = *(buf.ptr16);
-    payload_global->set_address((uint64_t)address);
-    payload_global->set_data_ptr(ptr);
+/* read n_words */
 
-	/**********	
-	To guarantee that there are no extensions in the payload
-	**********/
-	payload_global->free_all_extensions();	
+void ac_tlm2_nb_port::read(ac_ptr buf, uint32_t address,
+                         int wordsize, int n_words,sc_core::sc_time &time_info,unsigned int procId) {
 
+	const unsigned int bytes = wordsize / 8;
+	int issued = 0;
+	int retired = 0;
 
-    status = LOCAL_init_socket->nb_transport_fw(*payload_global, phase, time_info); 
-    if(status != tlm::TLM_UPDATED)
-    {
-	printf("\nAC_TLM2_NB_PORT  WRITE ERROR");
-	exit(0);
-    } 
-    
-    /*****/
-    delete payload_global;
-    wait(this->wake_up);
-    
-
-    break;
- 
- case 32:
-    payload_global->set_address((uint64_t)address);
-    payload_global->set_command(tlm::TLM_WRITE_COMMAND);
-    payload_global->set_data_length(sizeof(uint32_t));
+	#ifdef debugTLM2 
+	printf("\n\n*******AC_TLM2_NB_PORT READ N_WORDS: wordsize--> %d address-->%ld",wordsize,(long)address);
+	#endif
 
-    ((uint32_t*)p)[0]=*(buf.ptr32);
+	while (write_pending(address, n_words * bytes))
+		wait(write_done);
 
-    payload_global->set_data_ptr(p);    
+	// Keep up to the pool size of reads in flight. Our own reads only return
+	// to the pool once copied, so retire the oldest one before asking for a
+	// new slot when the pool runs dry.
+	std::vector<ac_tlm2_nb_transaction*> &window = read_window;
 
+	while (retired < n_words) {
+		if (issued < n_words && (!free_list.empty() || window.empty())) {
+			ac_tlm2_nb_transaction *t = alloc_transaction();
 
-    /**********	
-	To guarantee that there are no extensions in the payload
-	**********/
-	payload_global->free_all_extensions();	
-	
-    status = LOCAL_init_socket->nb_transport_fw(*payload_global, phase, time_info); 
+			prepare(t, tlm::TLM_READ_COMMAND, address + issued * bytes, wordsize, procId);
+			issue(t, time_info);
+			window.push_back(t);
+			issued++;
+		}
+		else {
+			ac_tlm2_nb_transaction *t = window.front();
+
+			wait_done(t);
+			memcpy(buf.ptr8 + retired * bytes, t->get_data_ptr(), bytes);
+			window.erase(window.begin());
+			t->release();
+			retired++;
+		}
+	}
+}
 
-    if(status != tlm::TLM_UPDATED)
-    {
-	printf("\nAC_TLM2_NB_PORT  WRITE ERROR");
-	exit(0);
-    } 
+/** 
+ * Posts a single write. The write is handed to the interconnect and the
+ * caller goes on without waiting for the response.
+ * 
+ */
+void ac_tlm2_nb_port::post_write(ac_ptr buf, uint32_t address, int wordsize,
+                                 sc_core::sc_time &time_info, unsigned int procId)
+{
+	ac_tlm2_nb_transaction *t = alloc_transaction();
 
+	prepare(t, tlm::TLM_WRITE_COMMAND, address, wordsize, procId);
+	memcpy(t->data, buf.ptr8, wordsize / 8);
+	t->posted = true;
 
-   /*****/
-    delete payload_global;
-    wait(this->wake_up);
-	
+	issue(t, time_info);
+}
 
-    break;
- 
-  case 64:
-  default:
-	printf("\n\nAC_TLM2_NB_PORT WRITE: wordsize not implemented");
-	exit(0);
-    break;
-  }
+/** 
+ * Writes a single word.
+ * 
+ * @param buf Buffer from which the word will be copied.
+ * @param address Address to where the word will be written.
+ * @param wordsize Word size in bits.
+ *
+ */
+void ac_tlm2_nb_port::write(ac_ptr buf, uint32_t address, int wordsize,sc_core::sc_time &time_info, unsigned int procId) {
 
-  
-  delete payload_global;
+  #ifdef debugTLM2 
+  printf("\n\n*******AC_TLM2_NB_PORT WRITE: wordsize--> %d address-->%ld",wordsize, (long)address);
+  #endif
 
+  post_write(buf, address, wordsize, time_info, procId);
 }
 
 /** 
@@ -510,11 +411,30 @@ void ac_tlm2_nb_port::write(ac_ptr buf, uint32_t address, int wordsize,sc_core::
 void ac_tlm2_nb_port::write(ac_ptr buf, uint32_t address,
                          int wordsize, int n_words,sc_core::sc_time &time_info, unsigned int procId) {
 
-  printf("ac_tlm2_nb_port write isn't implemented");
-  
+  const unsigned int bytes = wordsize / 8;
+
+  for (int i = 0; i < n_words; i++)
+    post_write(ac_ptr(buf.ptr8 + i * bytes), address + i * bytes, wordsize, time_info, procId);
 }
 
+/** 
+ * Waits until every posted write has been acknowledged.
+ * 
+ */
+void ac_tlm2_nb_port::flush()
+{
+  bool pending = true;
 
+  while (pending) {
+    pending = false;
+    for (unsigned int i = 0; i < in_flight.size(); i++)
+      if (in_flight[i]->posted)
+        pending = true;
+
+    if (pending)
+      wait(write_done);
+  }
+}
 
 
 string ac_tlm2_nb_port::get_name() const {
@@ -557,8 +477,7 @@ void ac_tlm2_nb_port::unlock()
  */
 ac_tlm2_nb_port::~ac_tlm2_nb_port() {
 
-	//delete payload_global;
+	for (unsigned int i = 0; i < pool.size(); i++)
+		delete pool[i];
  
 }
-
-
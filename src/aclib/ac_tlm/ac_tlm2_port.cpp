@@ -38,18 +38,44 @@
 // ArchC includes
 #include "ac_tlm2_port.H"
 #include "ac_tlm2_payload.H"
+#include "ac_parallel.H"
 
 // If you want to debug TLM 2.0, please uncomment the next line
 //#define debugTLM2
 
 // Constructors
 
-ac_tlm2_port::ac_tlm2_port(char const* nm, uint32_t sz) : name(nm), size(sz) {
+ac_tlm2_port::ac_tlm2_port(char const* nm, uint32_t sz) : dmi_mem(NULL), dmi_start(0), dmi_size(0),
+                                                           name(nm), size(sz) {
 
  payload = new ac_tlm2_payload();
  
  }
 
+/** 
+ * Sets up direct memory access.
+ * 
+ */
+void ac_tlm2_port::set_dmi(uint8_t *mem, uint32_t start, uint32_t sz, sc_core::sc_time latency)
+{
+    dmi_mem = mem;
+    dmi_start = start;
+    dmi_size = sz;
+    dmi_latency = latency;
+}
+
+/** 
+ * Calls b_transport. Processor threads hand the call to the SystemC side.
+ * 
+ */
+void ac_tlm2_port::transport(ac_tlm2_payload &p, sc_core::sc_time &time_info)
+{
+    if (ac_parallel::on_host_thread())
+        ac_parallel::serial([&] { (*this)->b_transport(p, time_info); });
+    else
+        (*this)->b_transport(p, time_info);
+}
+
 //////////////////////////////////////////////////////////////////////////////
 /** 
  * Reads a single word.
@@ -61,6 +87,16 @@ void ac_tlm2_port::read(ac_ptr buf, uint32_t address, int wordsize,sc_core::sc_t
     //sc_core::sc_time time_info;
     unsigned char buffer[64];
 
+    bool direct = is_dmi(address, wordsize / 8);
+
+    shared_access(address);
+    if (direct)
+    {
+        ac_parallel::read(buf.ptr8, dmi_mem + (address - dmi_start), wordsize / 8);
+        time_info += dmi_latency;
+        return;
+    }
+
     payload->set_command(tlm::TLM_READ_COMMAND);
     payload->set_address((sc_dt::uint64)address);
     payload->set_data_ptr(buffer);
@@ -83,7 +119,7 @@ void ac_tlm2_port::read(ac_ptr buf, uint32_t address, int wordsize,sc_core::sc_t
     printf("\n\nAC_TLM2_PORT READ: command-->%d address-->%ld",tlm::TLM_READ_COMMAND, address);
     #endif
 
-    (*this)->b_transport(*payload, time_info);
+    transport(*payload, time_info);
 
     uint8_t data8;
     uint16_t data16;
@@ -139,6 +175,16 @@ void ac_tlm2_port::read(ac_ptr buf, uint32_t address,
                          int wordsize, int n_words,sc_core::sc_time &time_info,unsigned int procId) {
 
     //sc_core::sc_time time_info = sc_core::sc_time(0, SC_NS);
+    bool direct = is_dmi(address, n_words * (wordsize / 8));
+
+    shared_access(address);
+    if (direct)
+    {
+        ac_parallel::read(buf.ptr8, dmi_mem + (address - dmi_start), n_words * (wordsize / 8));
+        time_info += dmi_latency;
+        return;
+    }
+
     payload->set_command(tlm::TLM_READ_COMMAND);
     
     unsigned char p[64];
@@ -162,7 +208,7 @@ void ac_tlm2_port::read(ac_ptr buf, uint32_t address,
                 /**/
 
 
-                (*this)->b_transport(*payload, time_info); 
+                transport(*payload, time_info); 
                 
                 for (int j = 0; (i < n_words) && (j < 4); j++, i++) {
                     (buf.ptr8)[i] = ((uint8_t*)p)[j];
@@ -183,7 +229,7 @@ void ac_tlm2_port::read(ac_ptr buf, uint32_t address,
                 payload->set_streaming_width((const unsigned int)procId);
                 /**/
 
-                (*this)->b_transport(*payload, time_info); 
+                transport(*payload, time_info); 
                 
                 for (int j = 0; (i < n_words) && (j < 2); j++, i++) {
                     buf.ptr16[i] = ((uint16_t*)p)[j];
@@ -204,7 +250,7 @@ void ac_tlm2_port::read(ac_ptr buf, uint32_t address,
                 payload->set_streaming_width((const unsigned int)procId);
                 /**/
 
-                (*this)->b_transport(*payload, time_info);      
+                transport(*payload, time_info);      
 
                 uint32_t *T = reinterpret_cast<uint32_t*>(p);
                 buf.ptr32[i]= T[0];
@@ -230,6 +276,16 @@ void ac_tlm2_port::write(ac_ptr buf, uint32_t address, int wordsize,sc_core::sc_
 
   unsigned char p[64];
 
+  bool direct = is_dmi(address, wordsize / 8);
+
+  shared_access(address);
+  if (direct)
+  {
+    ac_parallel::write(dmi_mem + (address - dmi_start), buf.ptr8, wordsize / 8);
+    time_info += dmi_latency;
+    return;
+  }
+
   #ifdef debugTLM2 
   printf("\n\nAC_TLM2_PORT WRITE: wordsize--> %d command-->%d address-->%ld",wordsize,tlm::TLM_WRITE_COMMAND, address);
   #endif
@@ -249,13 +305,13 @@ void ac_tlm2_port::write(ac_ptr buf, uint32_t address, int wordsize,sc_core::sc_
 
 
 
-        (*this)->b_transport(*payload, time_info); 
+        transport(*payload, time_info); 
         
         payload->set_command(tlm::TLM_WRITE_COMMAND);
         
         ((uint8_t*)p)[0] = *(buf.ptr8);
 
-        (*this)->b_transport(*payload, time_info);  
+        transport(*payload, time_info);  
       break;
       
       case 16:
@@ -271,7 +327,7 @@ void ac_tlm2_port::write(ac_ptr buf, uint32_t address, int wordsize,sc_core::sc_
         /**/
 
 
-        (*this)->b_transport(*payload, time_info); 
+        transport(*payload, time_info); 
 
         payload->set_command(tlm::TLM_WRITE_COMMAND);
         
@@ -280,7 +336,7 @@ void ac_tlm2_port::write(ac_ptr buf, uint32_t address, int wordsize,sc_core::sc_
 
         //((uint16_t*)p)[0] = *(buf.ptr16);
 
-        (*this)->b_transport(*payload, time_info);  
+        transport(*payload, time_info);  
       }
       break;
  
@@ -304,7 +360,7 @@ void ac_tlm2_port::write(ac_ptr buf, uint32_t address, int wordsize,sc_core::sc_
 
 
         payload->set_data_ptr(p);      
-        (*this)->b_transport(*payload, time_info); 
+        transport(*payload, time_info); 
       } 
       break;
 
@@ -323,6 +379,16 @@ void ac_tlm2_port::write(ac_ptr buf, uint32_t address,
                          int wordsize, int n_words,sc_core::sc_time &time_info,unsigned int procId) {
 
   //sc_core::sc_time time_info = sc_core::sc_time(0, SC_NS);
+  bool direct = is_dmi(address, n_words * sizeof(uint32_t));
+
+  shared_access(address);
+  if (direct)
+  {
+    ac_parallel::write(dmi_mem + (address - dmi_start), buf.ptr8, n_words * sizeof(uint32_t));
+    time_info += dmi_latency;
+    return;
+  }
+
   payload->set_command(tlm::TLM_WRITE_COMMAND);
 
   unsigned char p[64];
@@ -352,7 +418,7 @@ void ac_tlm2_port::write(ac_ptr buf, uint32_t address,
     printf("\nAC_TLM2_PORT WRITE: n_words--> %d  wordsize-->%d  i--> %d command-->  data-->%d",n_words, wordsize,i, payload->get_command(), *((uint32_t*)p));
     #endif
 
-    (*this)->b_transport(*payload, time_info);  
+    transport(*payload, time_info);  
   }
 }
 
@@ -371,8 +437,7 @@ uint32_t ac_tlm2_port::get_size() const {
  */
 void ac_tlm2_port::lock()
 {
-    printf("\nAC_TLM2_PORT::LOCK ERROR --> NOT IMPLEMENTED\n");  
-    exit(0);   
+    ac_parallel::lock(this);
 }
 
 /** 
@@ -381,8 +446,7 @@ void ac_tlm2_port::lock()
  */
 void ac_tlm2_port::unlock()
 {
-    printf("\nAC_TLM2_PORT::UNLOCK ERROR --> NOT IMPLEMENTED\n");  
-    exit(0);
+    ac_parallel::unlock(this);
 }
 
 //////////////////////////////////////////////////////////////////////////////
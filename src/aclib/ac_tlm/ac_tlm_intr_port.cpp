@@ -62,6 +62,7 @@
  */
 ac_tlm_intr_port::ac_tlm_intr_port(char const* nm, ac_intr_handler& hnd) :
   handler(hnd),
+  queue(NULL),
   name(nm) { bind(*this); }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -84,7 +85,11 @@ ac_tlm_rsp ac_tlm_intr_port::transport(const ac_tlm_req& req) {
 
   if (req.type == WRITE) {
     rsp.status = SUCCESS;
-    handler.handle(req.data);
+    interrupt();
+    if (queue)
+      queue->post(handler, req.data, 0);
+    else
+      handler.handle(req.data);
   }
   else {
     rsp.status = ERROR;
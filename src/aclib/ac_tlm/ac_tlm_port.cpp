@@ -40,6 +40,7 @@
 
 // ArchC includes
 #include "ac_tlm_port.H"
+#include "ac_parallel.H"
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -65,6 +66,22 @@ ac_tlm_port::ac_tlm_port(char const* nm, uint32_t sz) : name(nm), size(sz) {}
 
 // Methods
 
+/** 
+ * Sends a request to the device. Processor threads hand it to the
+ * SystemC side (see ac_parallel).
+ * 
+ */
+ac_tlm_rsp ac_tlm_port::transport(const ac_tlm_req &req)
+{
+  ac_tlm_rsp rsp;
+
+  if (ac_parallel::on_host_thread())
+    ac_parallel::serial([&] { rsp = (*this)->transport(req); });
+  else
+    rsp = (*this)->transport(req);
+  return rsp;
+}
+
 /** 
  * Reads a single word.
  * 
@@ -77,11 +94,13 @@ void ac_tlm_port::read(ac_ptr buf, uint32_t address, int wordsize) {
   ac_tlm_req req;
   ac_tlm_rsp rsp;
 
+  shared_access(address);
+
   req.type = READ;
   req.addr = address;
   req.data = 0ULL;
 
-  rsp = (*this)->transport(req);
+  rsp = transport(req);
 
   if (rsp.status == SUCCESS) {
     switch (wordsize) {
@@ -122,6 +141,8 @@ void ac_tlm_port::read(ac_ptr buf, uint32_t address,
   ac_tlm_req req;
   ac_tlm_rsp rsp;
 
+  shared_access(address);
+
   req.type = READ;
 
   switch (wordsize) {
@@ -130,7 +151,7 @@ void ac_tlm_port::read(ac_ptr buf, uint32_t address,
       req.addr = address + i;
       req.data = 0ULL;
       
-      rsp = (*this)->transport(req);
+      rsp = transport(req);
       
       if (rsp.status == SUCCESS) {
 	for (int j = 0; (i < n_words) && (j < 4); i++, j++) { 
@@ -145,7 +166,7 @@ void ac_tlm_port::read(ac_ptr buf, uint32_t address,
       req.addr = address + (i * sizeof(uint16_t));
       req.data = 0ULL;
       
-      rsp = (*this)->transport(req);
+      rsp = transport(req);
       
       if (rsp.status == SUCCESS) {
 	for (int j = 0; (i < n_words) && (j < 2); i++, j++) { 
@@ -160,7 +181,7 @@ void ac_tlm_port::read(ac_ptr buf, uint32_t address,
       req.addr = address + (i * sizeof(uint32_t));
       req.data = 0ULL;
       
-      rsp = (*this)->transport(req);
+      rsp = transport(req);
       
       if (rsp.status == SUCCESS) {
 	for (int j = 0; (i < n_words) && (j < 1); i++, j++) { 
@@ -175,7 +196,7 @@ void ac_tlm_port::read(ac_ptr buf, uint32_t address,
       req.addr = address + (i * sizeof(uint64_t));
       req.data = 0ULL;
       
-      rsp = (*this)->transport(req);
+      rsp = transport(req);
       
       if (rsp.status == SUCCESS) {
 	(buf.ptr64)[i] = rsp.data;
@@ -204,6 +225,8 @@ void ac_tlm_port::write(ac_ptr buf, uint32_t address, int wordsize) {
   ac_tlm_req req;
   ac_tlm_rsp rsp;
 
+  shared_access(address);
+
 //   req.type = WRITE;
 //   req.addr = address;
 
@@ -215,34 +238,34 @@ void ac_tlm_port::write(ac_ptr buf, uint32_t address, int wordsize) {
   case 8:
     req.type = READ;
     req.addr = address;
-    rsp = (*this)->transport(req);
+    rsp = transport(req);
 
     req.type = WRITE;
     req.data = rsp.data;
     ((uint8_t*)&(req.data8))[0] = *(buf.ptr8);
-    rsp = (*this)->transport(req);
+    rsp = transport(req);
     break;
   case 16:
     req.type = READ;
     req.addr = address;
-    rsp = (*this)->transport(req);
+    rsp = transport(req);
 
     req.type = WRITE;
     req.data = rsp.data;
     ((uint16_t*)&(req.data16))[0] =
       *(buf.ptr16);
-    rsp = (*this)->transport(req);
+    rsp = transport(req);
     break;
   case 32:
  //   req.type = READ;
     req.addr = address;
- //   rsp = (*this)->transport(req);
+ //   rsp = transport(req);
 
     req.type = WRITE;
     //req.data = rsp.data;
     ((uint32_t*)&(req.data))[0] =
       *(buf.ptr32);
-    rsp = (*this)->transport(req);
+    rsp = transport(req);
     break;
 
 // This is not a 64-bit operation!
@@ -250,7 +273,7 @@ void ac_tlm_port::write(ac_ptr buf, uint32_t address, int wordsize) {
     req.type = WRITE;
     req.addr = address;
     req.data = *(buf.ptr64);
-    rsp = (*this)->transport(req);
+    rsp = transport(req);
     break;
   default:
     break;
@@ -276,13 +299,15 @@ void ac_tlm_port::write(ac_ptr buf, uint32_t address,
   ac_tlm_req req;
   ac_tlm_rsp rsp;
 
+  shared_access(address);
+
   switch (wordsize) {
   case 8:
     for (int i = 0; i < n_words; i++) {
       req.type = READ;
       req.addr = address + i;
       req.data = 0ULL;
-      rsp = (*this)->transport(req);
+      rsp = transport(req);
 
       req.type = WRITE;
       req.data = rsp.data;
@@ -291,7 +316,7 @@ void ac_tlm_port::write(ac_ptr buf, uint32_t address,
 	((uint8_t*)&req.data8)[j] = (buf.ptr8)[i];
       }
       i--;
-      (*this)->transport(req);
+      transport(req);
     }
     break;
   case 16:
@@ -299,7 +324,7 @@ void ac_tlm_port::write(ac_ptr buf, uint32_t address,
       req.type = READ;
       req.addr = address + (i * sizeof(uint16_t));
       req.data = 0ULL;
-      rsp = (*this)->transport(req);
+      rsp = transport(req);
 
       req.type = WRITE;
       req.data = rsp.data;
@@ -308,7 +333,7 @@ void ac_tlm_port::write(ac_ptr buf, uint32_t address,
 	((uint16_t*)&req.data16)[j] = (buf.ptr16)[i];
       }
       i--;
-      (*this)->transport(req);
+      transport(req);
     }
     break;
   case 32:
@@ -316,7 +341,7 @@ void ac_tlm_port::write(ac_ptr buf, uint32_t address,
 //      req.type = READ;
       req.addr = address + (i * sizeof(uint32_t));
       req.data = 0ULL;
-//      rsp = (*this)->transport(req);
+//      rsp = transport(req);
 
       req.type = WRITE;
 //      req.data = rsp.data;
@@ -326,14 +351,14 @@ void ac_tlm_port::write(ac_ptr buf, uint32_t address,
 //        ((uint32_t*)&req.data)[j] = (buf.ptr32)[i];
 //      }
 //      i--;
-      (*this)->transport(req);
+      transport(req);
     }
     break;
   case 64:
     for (int i = 0; i < n_words; i++) {
       req.addr = address + (i * sizeof(uint64_t));
       req.data = (buf.ptr64)[i];
-      (*this)->transport(req);
+      transport(req);
     }
     break;
   default:
@@ -361,9 +386,13 @@ uint32_t ac_tlm_port::get_size() const {
 void ac_tlm_port::lock()
 {
   ac_tlm_req req;
+
+  // processors running in parallel also hold each other off
+  if (ac_parallel::on_host_thread())
+    ac_parallel::lock(this);
   req.type = LOCK;
   req.dev_id = dev_id_;
-  (*this)->transport(req);
+  transport(req);
 }
 
 /** 
@@ -375,7 +404,9 @@ void ac_tlm_port::unlock()
   ac_tlm_req req;
   req.type = UNLOCK;
   req.dev_id = dev_id_;
-  (*this)->transport(req);
+  transport(req);
+  if (ac_parallel::on_host_thread())
+    ac_parallel::unlock(this);
 }
 
 //////////////////////////////////////////////////////////////////////////////
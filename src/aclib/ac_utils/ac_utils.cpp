@@ -36,6 +36,11 @@
 
 #include "ac_utils.H"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AC_BLOCK_SWAP_X86
+#include <immintrin.h>
+#endif
+
 #ifdef USE_GDB
 #include "ac_gdb.H"
 // extern AC_GDB *gdbstub;
@@ -60,6 +65,39 @@ bool ac_do_trace;
 //Name of the file containing the application to be loaded.
 //char *appfilename;
 std::map<std::string, std::ofstream*> ac_cache_traces;
+std::map<std::string, int> ac_cache_trace_formats;
+std::map<std::string, std::string> ac_cache_configs;
+std::map<std::string, unsigned> ac_cache_sampling;
+std::map<std::string, unsigned> ac_cache_attribution_top;
+std::map<std::string, std::string> ac_cache_attribution_dumps;
+std::map<std::string, unsigned> ac_cache_mshrs;
+std::map<std::string, unsigned> ac_cache_miss_latencies;
+std::map<std::string, std::string> ac_cache_restores;
+std::map<std::string, std::string> ac_cache_saves;
+unsigned ac_quantum_min_ns = 0, ac_quantum_max_ns = 0;
+unsigned ac_shared_start = 0, ac_shared_size = 0;
+
+// Records one <cache>,<geometry> pair for --cache-config and its file form.
+static void add_cache_config(const std::string &arg)
+{
+    size_t comma = arg.find(',');
+    if (comma == std::string::npos || comma == 0 || comma+1 == arg.size()) {
+        std::cerr << "Error: invalid cache configuration: " << arg << "\n";
+        exit(EXIT_FAILURE);
+    }
+    ac_cache_configs[arg.substr(0, comma)] = arg.substr(comma+1);
+}
+
+// Records one <cache>,<file> pair for --cache-save and --cache-restore.
+static void add_cache_image(std::map<std::string, std::string> &images, const std::string &arg)
+{
+    size_t comma = arg.find(',');
+    if (comma == std::string::npos || comma == 0 || comma+1 == arg.size()) {
+        std::cerr << "Error: invalid argument syntax.\n";
+        exit(EXIT_FAILURE);
+    }
+    images[arg.substr(0, comma)] = arg.substr(comma+1);
+}
 
 //Read model options before application
 void ac_init_opts( int ac, char* av[]){
@@ -80,7 +118,27 @@ void ac_init_opts( int ac, char* av[]){
             cerr << "  --version               Display ArchC version and options used when built\n";
             cerr << "  --load=<prog_path>      Load target application\n";
             cerr << "  -- <prog_path>          Load target application\n";
-            cerr << "  --trace-cache=<cache>,<file> Trace cache access\n";
+            cerr << "  --trace-cache=<cache>,<file>[,binary|compressed] Trace cache access\n";
+            cerr << "  --cache-config=<cache>,<size>:<assoc>:<block>[:<policy>[:wb|wt]]\n";
+            cerr << "                          Set the geometry of a runtime-configurable cache\n";
+            cerr << "  --cache-config-file=<file> Read <cache>,<geometry> lines from a file\n";
+            cerr << "  --cache-sampling=<cache>,<n> Simulate one in <n> cache sets and estimate the rest\n";
+            cerr << "  --cache-attribution=<cache>[,<n>[,<file>]]\n";
+            cerr << "                          Report the <n> instructions with most misses (default 20),\n";
+            cerr << "                          writing all of them to <file>\n";
+            cerr << "  --cache-mshrs=<cache>,<n>[,<cycles>]\n";
+            cerr << "                          Time data cache <cache> as non-blocking, with <n> outstanding\n";
+            cerr << "                          misses of <cycles> each (default 100): loads do not wait for\n";
+            cerr << "                          their own misses, only for lines still being filled when\n";
+            cerr << "                          accessed again, or for a free MSHR\n";
+            cerr << "  --cache-restore=<cache>,<file> Start <cache> warm, from an image saved by --cache-save\n";
+            cerr << "  --cache-save=<cache>,<file> Save the contents of <cache> to <file> when the simulation ends\n";
+            cerr << "  --adaptive-quantum=<min>:<max>\n";
+            cerr << "                          Let the quantum of each processor adapt from <min> to <max> ns\n";
+            cerr << "  --shared-region=<start>:<size>\n";
+            cerr << "                          Shrink the adaptive quantum on accesses to the <size> bytes\n";
+            cerr << "                          at <start>, shared with other processors (otherwise only\n";
+            cerr << "                          interrupts do)\n";
 #ifdef USE_GDB
             //      cerr << "  --gdb[=<port>]          Enable GDB support\n";
 #endif /* USE_GDB */
@@ -168,8 +226,22 @@ args_t ac_init_args( int ac, char* av[]){
                 exit(EXIT_FAILURE);
             }
             std::string cache_name(av[1]+14, comma);
-            std::string file_name(comma+1, av[1]+size);
-            ac_cache_traces[cache_name] = new std::ofstream(file_name.c_str());
+            char *end = strchr(comma+1, ',');
+            int format = 0;     // trace_text
+            if (end == NULL)
+                end = av[1]+size;
+            else if (!strcmp(end+1, "binary"))
+                format = 1;     // trace_binary
+            else if (!strcmp(end+1, "compressed"))
+                format = 2;     // trace_binary_compressed
+            else {
+                std::cerr << "Error: unknown trace format: " << end+1 << "\n";
+                exit(EXIT_FAILURE);
+            }
+            std::string file_name(comma+1, end);
+            ac_cache_trace_formats[cache_name] = format;
+            ac_cache_traces[cache_name] = new std::ofstream(file_name.c_str(),
+                format ? std::ios::out | std::ios::binary : std::ios::out);
             if (!ac_cache_traces[cache_name]) {
                 std::cerr << "Error opening file: " << file_name << "\n";
                 exit(EXIT_FAILURE);
@@ -184,6 +256,161 @@ args_t ac_init_args( int ac, char* av[]){
             continue;
         }
 
+        else if ( (size>15) && (!strncmp(av[1], "--cache-config=", 15)) ) {
+            add_cache_config(av[1]+15);
+            for (int i = 1; i <= ac; i++) {
+                av[i] = av[i+1];
+            }
+
+            ac_argc--;
+            ac--;
+            continue;
+        }
+        else if ( (size>17) && (!strncmp(av[1], "--cache-sampling=", 17)) ) {
+            char *comma = strchr(av[1], ',');
+            char *end;
+            unsigned long ratio = comma ? strtoul(comma+1, &end, 0) : 0;
+            if (comma == NULL || comma == av[1]+17 || end == comma+1 || *end) {
+                std::cerr << "Error: invalid argument syntax.\n";
+                exit(EXIT_FAILURE);
+            }
+            ac_cache_sampling[std::string(av[1]+17, comma)] = ratio;
+            for (int i = 1; i <= ac; i++) {
+                av[i] = av[i+1];
+            }
+
+            ac_argc--;
+            ac--;
+            continue;
+        }
+        else if ( (size>20) && (!strncmp(av[1], "--cache-attribution=", 20)) ) {
+            char *comma = strchr(av[1], ',');
+            char *end = NULL;
+            unsigned long top = 20;
+            if (comma)
+                top = strtoul(comma+1, &end, 0);
+            if (comma == av[1]+20 || (comma && (end == comma+1 || (*end && *end != ',')))) {
+                std::cerr << "Error: invalid argument syntax.\n";
+                exit(EXIT_FAILURE);
+            }
+            std::string cache_name(av[1]+20, comma ? comma : av[1]+size);
+            ac_cache_attribution_top[cache_name] = top;
+            if (end && *end == ',')
+                ac_cache_attribution_dumps[cache_name] = end+1;
+            for (int i = 1; i <= ac; i++) {
+                av[i] = av[i+1];
+            }
+
+            ac_argc--;
+            ac--;
+            continue;
+        }
+        else if ( (size>14) && (!strncmp(av[1], "--cache-mshrs=", 14)) ) {
+            char *comma = strchr(av[1], ',');
+            char *end = NULL;
+            unsigned long mshrs = 0, latency = 100;
+            bool ok = comma && comma != av[1]+14;
+            if (ok) {
+                mshrs = strtoul(comma+1, &end, 0);
+                ok = end != comma+1;
+            }
+            if (ok && *end == ',') {
+                char *num = end+1;
+                latency = strtoul(num, &end, 0);
+                ok = end != num;
+            }
+            if (!ok || *end) {
+                std::cerr << "Error: invalid argument syntax.\n";
+                exit(EXIT_FAILURE);
+            }
+            std::string cache_name(av[1]+14, comma);
+            ac_cache_mshrs[cache_name] = mshrs;
+            ac_cache_miss_latencies[cache_name] = latency;
+            for (int i = 1; i <= ac; i++) {
+                av[i] = av[i+1];
+            }
+
+            ac_argc--;
+            ac--;
+            continue;
+        }
+        else if ( (size>16) && (!strncmp(av[1], "--cache-restore=", 16)) ) {
+            add_cache_image(ac_cache_restores, av[1]+16);
+            for (int i = 1; i <= ac; i++) {
+                av[i] = av[i+1];
+            }
+
+            ac_argc--;
+            ac--;
+            continue;
+        }
+        else if ( (size>13) && (!strncmp(av[1], "--cache-save=", 13)) ) {
+            add_cache_image(ac_cache_saves, av[1]+13);
+            for (int i = 1; i <= ac; i++) {
+                av[i] = av[i+1];
+            }
+
+            ac_argc--;
+            ac--;
+            continue;
+        }
+        else if ( (size>19) && (!strncmp(av[1], "--adaptive-quantum=", 19)) ) {
+            char *end;
+            ac_quantum_min_ns = strtoul(av[1]+19, &end, 0);
+            if (end == av[1]+19 || *end != ':' ||
+                (ac_quantum_max_ns = strtoul(end+1, &end, 0), *end) ||
+                ac_quantum_min_ns == 0 || ac_quantum_max_ns < ac_quantum_min_ns) {
+                std::cerr << "Error: invalid argument syntax.\n";
+                exit(EXIT_FAILURE);
+            }
+            for (int i = 1; i <= ac; i++) {
+                av[i] = av[i+1];
+            }
+
+            ac_argc--;
+            ac--;
+            continue;
+        }
+        else if ( (size>16) && (!strncmp(av[1], "--shared-region=", 16)) ) {
+            char *end;
+            ac_shared_start = strtoul(av[1]+16, &end, 0);
+            if (end == av[1]+16 || *end != ':' ||
+                (ac_shared_size = strtoul(end+1, &end, 0), *end) ||
+                ac_shared_size == 0) {
+                std::cerr << "Error: invalid argument syntax.\n";
+                exit(EXIT_FAILURE);
+            }
+            for (int i = 1; i <= ac; i++) {
+                av[i] = av[i+1];
+            }
+
+            ac_argc--;
+            ac--;
+            continue;
+        }
+        else if ( (size>20) && (!strncmp(av[1], "--cache-config-file=", 20)) ) {
+            std::ifstream config(av[1]+20);
+            std::string line;
+            if (!config) {
+                std::cerr << "Error opening file: " << av[1]+20 << "\n";
+                exit(EXIT_FAILURE);
+            }
+            // one <cache>,<geometry> per line; blank lines and # comments are skipped
+            while (std::getline(config, line)) {
+                line.erase(0, line.find_first_not_of(" \t"));
+                line.erase(line.find_last_not_of(" \t\r") + 1);
+                if (!line.empty() && line[0] != '#')
+                    add_cache_config(line);
+            }
+            for (int i = 1; i <= ac; i++) {
+                av[i] = av[i+1];
+            }
+
+            ac_argc--;
+            ac--;
+            continue;
+        }
+
         ac --;
         av ++;
     }
@@ -221,3 +448,151 @@ unsigned int convert_endian(unsigned int size, unsigned int num, bool match_endi
 
   return out;
 }
+
+// Scalar byte swap of n_words elements of wordsize bytes.
+static void block_swap_scalar(uint8_t *dst, const uint8_t *src, unsigned int n_words, unsigned int wordsize)
+{
+  unsigned int i;
+
+  switch (wordsize) {
+  case 2:
+    for (i = 0; i < n_words; i++, src += 2, dst += 2) {
+      uint16_t w;
+      memcpy(&w, src, 2);
+      w = __builtin_bswap16(w);
+      memcpy(dst, &w, 2);
+    }
+    break;
+  case 4:
+    for (i = 0; i < n_words; i++, src += 4, dst += 4) {
+      uint32_t w;
+      memcpy(&w, src, 4);
+      w = __builtin_bswap32(w);
+      memcpy(dst, &w, 4);
+    }
+    break;
+  case 8:
+    for (i = 0; i < n_words; i++, src += 8, dst += 8) {
+      uint64_t w;
+      memcpy(&w, src, 8);
+      w = __builtin_bswap64(w);
+      memcpy(dst, &w, 8);
+    }
+    break;
+  default:
+    if (dst != src)
+      memmove(dst, src, n_words * wordsize);
+    for (i = 0; i < n_words; i++, dst += wordsize) {
+      for (unsigned int j = 0; j < wordsize / 2; j++) {
+        uint8_t b = dst[j];
+        dst[j] = dst[wordsize - 1 - j];
+        dst[wordsize - 1 - j] = b;
+      }
+    }
+    break;
+  }
+}
+
+#ifdef AC_BLOCK_SWAP_X86
+
+// Shuffle control reversing each element inside a 16-byte lane.
+static void block_swap_mask(uint8_t *mask, unsigned int wordsize)
+{
+  for (unsigned int i = 0; i < 16; i++)
+    mask[i] = (i - i % wordsize) + (wordsize - 1 - i % wordsize);
+}
+
+// Both return the number of bytes processed, always a multiple of the
+// vector width; the caller handles the remainder.
+__attribute__((target("ssse3")))
+static unsigned int block_swap_ssse3(uint8_t *dst, const uint8_t *src, unsigned int size, unsigned int wordsize)
+{
+  uint8_t m[16];
+  unsigned int i;
+
+  block_swap_mask(m, wordsize);
+  __m128i mask = _mm_loadu_si128((const __m128i *)m);
+
+  for (i = 0; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+    _mm_storeu_si128((__m128i *)(dst + i), _mm_shuffle_epi8(v, mask));
+  }
+  return i;
+}
+
+__attribute__((target("avx2")))
+static unsigned int block_swap_avx2(uint8_t *dst, const uint8_t *src, unsigned int size, unsigned int wordsize)
+{
+  uint8_t m[16];
+  unsigned int i;
+
+  block_swap_mask(m, wordsize);
+  __m128i lane = _mm_loadu_si128((const __m128i *)m);
+  __m256i mask = _mm256_broadcastsi128_si256(lane);
+
+  for (i = 0; i + 32 <= size; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+    _mm256_storeu_si256((__m256i *)(dst + i), _mm256_shuffle_epi8(v, mask));
+  }
+  return i;
+}
+
+#endif /* AC_BLOCK_SWAP_X86 */
+
+void ac_block_swap(void *dst, const void *src, unsigned int size, unsigned int wordsize)
+{
+  uint8_t *d = (uint8_t *) dst;
+  const uint8_t *s = (const uint8_t *) src;
+  unsigned int done = 0;
+
+  if (wordsize < 2) {
+    if (d != s)
+      memmove(d, s, size);
+    return;
+  }
+
+#ifdef AC_BLOCK_SWAP_X86
+  // Vector shuffles only handle elements that evenly divide a lane.
+  if (wordsize == 2 || wordsize == 4 || wordsize == 8) {
+    static const int has_avx2 = __builtin_cpu_supports("avx2");
+    static const int has_ssse3 = __builtin_cpu_supports("ssse3");
+
+    if (has_avx2)
+      done = block_swap_avx2(d, s, size, wordsize);
+    else if (has_ssse3)
+      done = block_swap_ssse3(d, s, size, wordsize);
+  }
+#endif
+
+  unsigned int n_words = (size - done) / wordsize;
+  block_swap_scalar(d + done, s + done, n_words, wordsize);
+  done += n_words * wordsize;
+
+  if (done < size && d != s)
+    memmove(d + done, s + done, size - done);
+}
+
+void ac_elf_to_host(Elf32_Ehdr &ehdr, bool match_endian)
+{
+  if (match_endian)
+    return;
+
+  // e_type, e_machine
+  ac_block_swap(&ehdr.e_type, &ehdr.e_type, 2 * sizeof(Elf32_Half), sizeof(Elf32_Half));
+  // e_version .. e_flags
+  ac_block_swap(&ehdr.e_version, &ehdr.e_version,
+                (char *)&ehdr.e_ehsize - (char *)&ehdr.e_version, sizeof(Elf32_Word));
+  // e_ehsize .. e_shstrndx
+  ac_block_swap(&ehdr.e_ehsize, &ehdr.e_ehsize,
+                (char *)(&ehdr + 1) - (char *)&ehdr.e_ehsize, sizeof(Elf32_Half));
+}
+
+void ac_elf_to_host(Elf32_Phdr &phdr, bool match_endian)
+{
+  ac_block_convert_endian(&phdr, sizeof(phdr), sizeof(Elf32_Word), match_endian);
+}
+
+void ac_elf_to_host(Elf32_Shdr &shdr, bool match_endian)
+{
+  ac_block_convert_endian(&shdr, sizeof(shdr), sizeof(Elf32_Word), match_endian);
+}
@@ -585,6 +585,8 @@ int add_storage(char* name, unsigned size, ac_sto_types type, char* typestr, cha
   pstorage->higher = NULL;
   pstorage->level = 0;
   pstorage->width = 0;
+  pstorage->cache_object = NULL;
+  pstorage->class_declaration = NULL;
 
   //Checking if the user declared a specific register width
   if(  ((type == REGBANK) || (type == REG)) && reg_width != 0  ){
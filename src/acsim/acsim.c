@@ -85,6 +85,12 @@ int  ACPCAddress=1;                             //!<Indicates if PC bounds is ve
 int  ACFullDecode=0;                            //!<Indicates if Full Decode Optimization is turned on or not
 int  ACCurInstrID=1;                            //!<Indicates if Current Instruction ID is save in dispatch
 int  ACPowerEnable=0;                           //!<Indicates if Power Estimation is enabled
+int  ACHostNativeMem=0;                         //!<Indicates if memories keep guest words in host byte order
+int  ACCacheAnalysis=0;                         //!<Indicates if single-pass cache analysis is enabled
+int  ACRuntimeCaches=0;                         //!<Indicates if cache geometry is set at simulation time
+int  ACParallel=0;                              //!<Indicates if processors run on host threads
+int  ACDeferredIntr=0;                          //!<Indicates if interrupt handlers run at the processor's safe points
+int  ACStandalone=0;                            //!<Indicates if the simulator is built without SystemC
 
 char ACOptions[500];                            //!<Stores ArchC recognized command line options
 char *ACOptions_p = ACOptions;                  //!<Pointer used to append options in ACOptions
@@ -141,6 +147,12 @@ struct option_map option_map[] = {
   {"--full-decode"     , "-fdc","Enable Full Decode Optimization.", 0},
   {"--no-curr-instr-id", "-nci","Disable Current Instruction ID save in dispatch.", 0},
   {"--power"           , "-pw" ,"Enable Power Estimation.", 0},
+  {"--host-native-mem" , "-hnm","Keep guest words in host byte order inside internal memories.", 0},
+  {"--cache-analysis"  , "-ca" ,"Report miss ratios for a grid of cache sizes and associativities in one run.", 0},
+  {"--runtime-caches"  , "-rc" ,"Let --cache-config change cache geometry without regenerating the simulator.", 0},
+  {"--parallel"        , "-par","Run each processor on a host thread of its own, synchronized every quantum.", 0},
+  {"--deferred-interrupts", "-di","Run interrupt handlers on the processor's thread, at control-flow instructions and quantum syncs.", 0},
+  {"--standalone"      , "-sa" ,"Build a standalone simulator, without SystemC (models without TLM ports).", 0},
   { }
 };
 
@@ -238,6 +250,8 @@ int main(int argc, char** argv) {
   extern int HaveTLMIntrPorts;
 /***/
   extern int HaveTLM2IntrPorts;
+  extern int HaveTLMPorts, HaveTLM2Ports, HaveTLM2NBPorts;
+  extern int HaveMemHier;
 
   extern ac_decoder_full *decoder;
 
@@ -378,6 +392,31 @@ int main(int argc, char** argv) {
             case OPPower:
               ACPowerEnable = 1;
               ACOptions_p += sprintf( ACOptions_p, "%s ", argv[0]);
+              break;
+            case OPHostNativeMem:
+              ACHostNativeMem = 1;
+              ACOptions_p += sprintf( ACOptions_p, "%s ", argv[0]);
+              break;
+            case OPCacheAnalysis:
+              ACCacheAnalysis = 1;
+              ACOptions_p += sprintf( ACOptions_p, "%s ", argv[0]);
+              break;
+            case OPRuntimeCaches:
+              ACRuntimeCaches = 1;
+              ACOptions_p += sprintf( ACOptions_p, "%s ", argv[0]);
+              break;
+            case OPParallel:
+              ACParallel = 1;
+              ACOptions_p += sprintf( ACOptions_p, "%s ", argv[0]);
+              break;
+            case OPDeferredIntr:
+              ACDeferredIntr = 1;
+              ACOptions_p += sprintf( ACOptions_p, "%s ", argv[0]);
+              break;
+            case OPStandalone:
+              ACStandalone = 1;
+              ACOptions_p += sprintf( ACOptions_p, "%s ", argv[0]);
+              break;
             default:
               break;
           }
@@ -395,6 +434,16 @@ int main(int argc, char** argv) {
   
   if ( !ACDecCacheFlag ) ACFullDecode = 0;
 
+  if (ACParallel && !ACWaitFlag) {
+    AC_ERROR("--parallel synchronizes processors at the quantum syncs that --no-wait removes.\n");
+    return EXIT_FAILURE;
+  }
+
+  if (ACStandalone && (ACParallel || ACVerboseFlag || ACPowerEnable)) {
+    AC_ERROR("--standalone builds simulators without SystemC, which --parallel, --verbose and --power need.\n");
+    return EXIT_FAILURE;
+  }
+
   //Loading Configuration Variables
   ReadConfFile();
 
@@ -428,6 +477,24 @@ int main(int argc, char** argv) {
   if (error_flag)
     return EXIT_FAILURE;
 
+  if (ACStandalone && (HaveTLMPorts || HaveTLM2Ports || HaveTLM2NBPorts ||
+                       HaveTLMIntrPorts || HaveTLM2IntrPorts)) {
+    AC_ERROR("--standalone builds simulators without SystemC, for models without TLM ports.\n");
+    return EXIT_FAILURE;
+  }
+
+  //Caches keep the coherence directory and the shared levels for all
+  //processors, which would be updated from every host thread.
+  if (ACParallel && HaveMemHier) {
+    AC_ERROR("--parallel runs processors on host threads, which models with a memory hierarchy cannot use.\n");
+    return EXIT_FAILURE;
+  }
+
+  if (ACDeferredIntr && !HaveTLMIntrPorts && !HaveTLM2IntrPorts) {
+    AC_MSG("Warning: --deferred-interrupts ignored, the model has no interrupt ports.\n");
+    ACDeferredIntr = 0;
+  }
+
   if( wordsize == 0){
     AC_MSG("Warning: No wordsize defined. Default value is 32 bits.\n");
     wordsize = 32;
@@ -453,6 +520,21 @@ int main(int argc, char** argv) {
 
   ac_match_endian = (ac_host_endian == ac_tgt_endian);
 
+  //Host-native storage changes the byte layout seen by the memory device,
+  //which is only safe when nobody outside the simulator looks at it.
+  if (ACHostNativeMem) {
+    extern int HaveTLMPorts, HaveTLM2Ports, HaveTLM2NBPorts;
+
+    if (ac_match_endian) {
+      AC_MSG("Warning: Host and target endianness match. Option --host-native-mem has no effect.\n");
+      ACHostNativeMem = 0;
+    }
+    else if (HaveTLMPorts || HaveTLM2Ports || HaveTLM2NBPorts) {
+      AC_MSG("Warning: Option --host-native-mem is not supported with TLM ports and will be ignored.\n");
+      ACHostNativeMem = 0;
+    }
+  }
+
   //If target is little endian, invert the order of fields in each format. 
   //This is the way the little endian decoder expects format fields.
   if (ac_tgt_endian == 0)
@@ -622,6 +704,14 @@ void CreateArchHeader() {
         fprintf(output, "#include \"ac_random_replacement_policy.H\"\n");
         fprintf(output, "#include \"ac_plrum_replacement_policy.H\"\n");
         fprintf(output, "#include \"ac_lru_replacement_policy.H\"\n");
+        fprintf(output, "#include \"ac_tree_plru_replacement_policy.H\"\n");
+        fprintf(output, "#include \"ac_rrip_replacement_policy.H\"\n");
+        fprintf(output, "#include \"ac_next_line_prefetcher.H\"\n");
+        fprintf(output, "#include \"ac_stride_prefetcher.H\"\n");
+        fprintf(output, "#include \"ac_stream_prefetcher.H\"\n");
+        if (ACRuntimeCaches)
+            fprintf(output, "#include \"ac_runtime_cache.H\"\n");
+        fprintf(output, "#include \"ac_cache_level.H\"\n");
         fprintf(output, "#include \"ac_cache_if.H\"\n");
     }
 
@@ -724,7 +814,17 @@ void CreateArchHeader() {
                     if (p == NULL)
                         abort();
 
-                    fprintf(output, "%s%s %s;\n", INDENT[1], pstorage->class_declaration, pstorage->name);
+                    if (IsCacheLevel(pstorage)) {
+                        // the memory under the last level is reached through its port
+                        if (!IsCacheLevel(pstorage->higher))
+                            fprintf(output, "%sac_cache_memory_port<%s_parms::ac_word, %s > %s_next;\n",
+                                    INDENT[1], project_name, pstorage->higher->class_declaration,
+                                    pstorage->name);
+                        fprintf(output, "%s%s %s%s;\n", INDENT[1], pstorage->class_declaration,
+                                pstorage->cache_object->shared ? "&" : "", pstorage->name);
+                    }
+                    else
+                        fprintf(output, "%s%s %s;\n", INDENT[1], pstorage->class_declaration, pstorage->name);
 
                     if (pstorage->level == 0) {
                         fprintf(output, "%sac_cache_if<%s_parms::ac_word, %s_parms::ac_Hword, %s >" 
@@ -851,6 +951,13 @@ void CreateArchRefHeader() {
         fprintf(output, "#include \"ac_random_replacement_policy.H\"\n");
         fprintf(output, "#include \"ac_plrum_replacement_policy.H\"\n");
         fprintf(output, "#include \"ac_lru_replacement_policy.H\"\n");
+        fprintf(output, "#include \"ac_tree_plru_replacement_policy.H\"\n");
+        fprintf(output, "#include \"ac_rrip_replacement_policy.H\"\n");
+        fprintf(output, "#include \"ac_next_line_prefetcher.H\"\n");
+        fprintf(output, "#include \"ac_stride_prefetcher.H\"\n");
+        fprintf(output, "#include \"ac_stream_prefetcher.H\"\n");
+        if (ACRuntimeCaches)
+            fprintf(output, "#include \"ac_runtime_cache.H\"\n");
     }
 
 
@@ -1517,6 +1624,9 @@ void CreateProcessorHeader() {
 
   extern ac_sto_list *tlm_intr_port_list;
   ac_sto_list *pport;
+  extern ac_sto_list *storage_list;
+  extern int HaveMemHier;
+  ac_sto_list *pstorage;
   extern ac_dec_instr *instr_list;
   char filename[256];
   char description[] = "Architecture Module header file.";
@@ -1545,6 +1655,10 @@ void CreateProcessorHeader() {
 #endif
   fprintf( output, "#include \"%s_arch.H\"\n", project_name);
   fprintf( output, "#include \"%s_isa.H\"\n", project_name);
+
+  /* non-blocking caches charge their stalls to the quantum keeper */
+  if (HaveMemHier && ACWaitFlag)
+    fprintf( output, "#include \"ac_cache_qk_clock.H\"\n");
   
   // POWER ESTIMATION SUPPORT
 
@@ -1649,6 +1763,9 @@ if (HaveTLM2IntrPorts) {
   //fprintf( output, "%sunsigned id;\n", INDENT[1]);
   fprintf( output, "%sbool start_up;\n", INDENT[1]);
 
+  if (HaveMemHier && ACWaitFlag)
+    fprintf( output, "%sac_cache_qk_clock cache_clock;\n", INDENT[1]);
+
   if (ACGDBIntegrationFlag)
     fprintf(output, "%sAC_GDB<%s_parms::ac_word>* gdbstub;\n\n", 
             INDENT[1], project_name);
@@ -1665,6 +1782,11 @@ if (HaveTLM2IntrPorts) {
   COMMENT(INDENT[1], "Behavior execution method.");
   fprintf( output, "%svoid behavior();\n\n", INDENT[1]);
 
+  if (ACParallel) {
+    COMMENT(INDENT[1], "Behavior run on a host thread (see ac_parallel).");
+    fprintf( output, "%svoid parallel_behavior();\n\n", INDENT[1]);
+  }
+
   if (ACVerboseFlag) {
     COMMENT(INDENT[1], "Verification method.");
     fprintf( output, "%svoid ac_verify();\n\n", INDENT[1]);
@@ -1674,6 +1796,13 @@ if (HaveTLM2IntrPorts) {
  
   fprintf( output, "%ssc_event wake;\n\n", INDENT[1]);
 
+  if (ACDeferredIntr) {
+    COMMENT(INDENT[1], "Interrupts waiting for the next safe point.");
+    fprintf( output, "%sac_intr_queue intr_queue;\n\n", INDENT[1]);
+    COMMENT(INDENT[1], "Runs the pending interrupt handlers, sleeping while intr_reg is 0.");
+    fprintf( output, "%svoid handle_interrupts();\n\n", INDENT[1]);
+  }
+
 
   //!Declaring ARCH Constructor.
   COMMENT(INDENT[1], "Constructor.");
@@ -1699,6 +1828,9 @@ if (HaveTLM2IntrPorts) {
 
 
   
+  if (HaveMemHier && ACWaitFlag)
+    fprintf(output, ", cache_clock(ac_qk, module_period_ns)");
+
   if (HaveTLMIntrPorts) {
     for (pport = tlm_intr_port_list; pport != NULL; pport = pport->next) {
       fprintf(output, ", %s_hnd(*this,&wake)", pport->name);
@@ -1716,11 +1848,17 @@ if (HaveTLM2IntrPorts) {
          }
        }
 
+  if (ACDeferredIntr)
+    fprintf(output, ", intr_queue(wake)");
+
 
   fprintf(output, " {\n");
 
-  fprintf( output, "%sSC_THREAD( behavior );\n", INDENT[2]);
-  fprintf( output, "%ssensitive << wake;\n", INDENT[2]);
+  //Standalone simulators call run() instead.
+  if (!ACStandalone) {
+    fprintf( output, "%sSC_THREAD( behavior );\n", INDENT[2]);
+    fprintf( output, "%ssensitive << wake;\n", INDENT[2]);
+  }
 
   if (ACVerboseFlag) {
     fprintf( output, "%sSC_THREAD( ac_verify );\n", INDENT[2]);
@@ -1733,13 +1871,52 @@ if (HaveTLM2IntrPorts) {
   fprintf( output, "%sid.write(globalId++);\n", INDENT[2]);
  
     
-  if (ACGDBIntegrationFlag)
-    fprintf(output, "%sgdbstub = new AC_GDB<%s_parms::ac_word>(this, %s_parms::GDB_PORT_NUM);\n\n", 
+  if (ACGDBIntegrationFlag) {
+    fprintf(output, "%sgdbstub = new AC_GDB<%s_parms::ac_word>(this, %s_parms::GDB_PORT_NUM);\n", 
             INDENT[2], project_name, project_name);
 
-  if (ACWaitFlag)
+    //Every memory port checks the GDB watchpoints.
+    for (pstorage = storage_list; pstorage != NULL; pstorage = pstorage->next) {
+      switch (pstorage->type) {
+      case REG:
+      case REGBANK:
+      case TLM_INTR_PORT:
+      case TLM2_INTR_PORT:
+        break;
+
+      case CACHE:
+      case ICACHE:
+      case DCACHE:
+        if (HaveMemHier && pstorage->level != 0)
+          break;
+        /* fall through */
+
+      default:
+        fprintf(output, "%s%s_mport.set_watchpoints(gdbstub->get_watchpoints());\n",
+                INDENT[2], pstorage->name);
+        break;
+      }
+    }
+    fprintf(output, "\n");
+  }
+
+  if (ACWaitFlag) {
     fprintf(output, "%sset_proc_freq(1000/module_period_ns);\n", INDENT[2]);
 
+    //TLM ports tell the quantum keeper about interactions.
+    for (pstorage = storage_list; pstorage != NULL; pstorage = pstorage->next)
+      if (pstorage->type == TLM_PORT || pstorage->type == TLM2_PORT ||
+          pstorage->type == TLM_INTR_PORT || pstorage->type == TLM2_INTR_PORT)
+        fprintf(output, "%s%s.set_quantumkeeper(&ac_qk);\n", INDENT[2], pstorage->name);
+  }
+
+  if (ACDeferredIntr) {
+    for (pport = tlm_intr_port_list; pport != NULL; pport = pport->next)
+      fprintf(output, "%s%s.set_intr_queue(&intr_queue);\n", INDENT[2], pport->name);
+    for (pport = tlm2_intr_port_list; pport != NULL; pport = pport->next)
+      fprintf(output, "%s%s.set_intr_queue(&intr_queue);\n", INDENT[2], pport->name);
+  }
+
   fprintf( output, "%s}\n\n", INDENT[1]);  //end constructor
 
   if(ACDecCacheFlag) {
@@ -2036,7 +2213,7 @@ void CreateStatsImplTmpl() {
 
 //!Creates Processor Module Implementation File
 void CreateProcessorImpl() {
-    extern ac_sto_list *storage_list;
+    extern ac_sto_list *storage_list, *fetch_device;
     extern char *project_name;
     extern int HaveMemHier, ACGDBIntegrationFlag, largest_format_size;
     ac_sto_list *pstorage;
@@ -2064,7 +2241,17 @@ void CreateProcessorImpl() {
     if( ACThreading )
         EmitDispatch(output, 0);
 
-    fprintf( output, "void %s::behavior() {\n\n", project_name);
+    if (ACDeferredIntr)
+        EmitIntrHandling(output);
+
+    if (ACParallel) {
+        fprintf( output, "void %s::behavior() {\n", project_name);
+        fprintf( output, "%sac_parallel::run(this, [this] { parallel_behavior(); });\n", INDENT[1]);
+        fprintf( output, "}\n\n");
+        fprintf( output, "void %s::parallel_behavior() {\n\n", project_name);
+    }
+    else
+        fprintf( output, "void %s::behavior() {\n\n", project_name);
     if( ACDebugFlag ){
         fprintf( output, "%sextern bool ac_do_trace;\n", INDENT[1]);
         fprintf( output, "%sextern ofstream trace_file;\n", INDENT[1]);
@@ -2168,9 +2355,40 @@ void CreateProcessorImpl() {
             case CACHE:
             case ICACHE:
             case DCACHE:
+                if (ACRuntimeCaches && pstorage->parms)
+                    fprintf(output, "%sif (ac_cache_configs.find(\"%s\") != ac_cache_configs.end()) "
+                            "%s.configure(ac_cache_configs[\"%s\"]);\n",
+                            INDENT[1], pstorage->name, pstorage->name, pstorage->name);
+                if (pstorage->parms)
+                    fprintf(output, "%sif (ac_cache_restores.find(\"%s\") != ac_cache_restores.end()) "
+                            "%s.restore_state(ac_cache_restores[\"%s\"]);\n",
+                            INDENT[1], pstorage->name, pstorage->name, pstorage->name);
+                if (pstorage->parms && !IsCacheLevel(pstorage))
+                    fprintf(output, "%sif (ac_cache_sampling.find(\"%s\") != ac_cache_sampling.end()) "
+                            "%s.set_sampling(ac_cache_sampling[\"%s\"]);\n",
+                            INDENT[1], pstorage->name, pstorage->name, pstorage->name);
+                //Misses of the fetch cache hold the processor until the
+                //instruction comes back, so only data caches overlap them.
+                if (pstorage->parms && !IsCacheLevel(pstorage) && ACWaitFlag &&
+                    (pstorage == fetch_device || pstorage->type == ICACHE)) {
+                    fprintf(output, "%sif (ac_cache_mshrs.find(\"%s\") != ac_cache_mshrs.end()) {\n",
+                            INDENT[1], pstorage->name);
+                    fprintf(output, "%scerr << \"ArchC: --cache-mshrs: %s fetches instructions, which wait for their misses.\" << endl;\n",
+                            INDENT[2], pstorage->name);
+                    fprintf(output, "%sexit(EXIT_FAILURE);\n", INDENT[2]);
+                    fprintf(output, "%s}\n", INDENT[1]);
+                }
+                else if (pstorage->parms && !IsCacheLevel(pstorage) && ACWaitFlag)
+                    fprintf(output, "%sif (ac_cache_mshrs.find(\"%s\") != ac_cache_mshrs.end()) "
+                            "%s.set_nonblocking(ac_cache_mshrs[\"%s\"], ac_cache_miss_latencies[\"%s\"], &cache_clock);\n",
+                            INDENT[1], pstorage->name, pstorage->name, pstorage->name, pstorage->name);
+                if (pstorage->parms && !IsCacheLevel(pstorage))
+                    fprintf(output, "%sif (ac_cache_attribution_top.find(\"%s\") != ac_cache_attribution_top.end()) "
+                            "%s.set_attribution(ac_cache_attribution_top[\"%s\"], ac_cache_attribution_dumps[\"%s\"], appfilename);\n",
+                            INDENT[1], pstorage->name, pstorage->name, pstorage->name, pstorage->name);
                 fprintf(output, "%sif (ac_cache_traces.find(\"%s\") != ac_cache_traces.end()) "
-                        "%s.set_trace(*ac_cache_traces[\"%s\"]);\n",
-                        INDENT[1], pstorage->name, pstorage->name, pstorage->name);
+                        "%s.set_trace(*ac_cache_traces[\"%s\"], (trace_format) ac_cache_trace_formats[\"%s\"]);\n",
+                        INDENT[1], pstorage->name, pstorage->name, pstorage->name, pstorage->name);
             default: 
                 continue;
         }
@@ -2208,15 +2426,53 @@ void CreateProcessorImpl() {
     fprintf(output, "%sargs_t args = ac_init_args( ac, av);\n", INDENT[1]);
     fprintf(output, "%sset_args(args.size, args.app_args);\n", INDENT[1]);
     fprintf(output, "%s%s_mport.load(args.app_filename);\n", INDENT[1], load_device->name);
+    if (ACWaitFlag) {
+        fprintf(output, "%sif (ac_quantum_max_ns) set_adaptive_quantum(ac_quantum_min_ns, ac_quantum_max_ns);\n", INDENT[1]);
+        for (pstorage = storage_list; pstorage != NULL; pstorage = pstorage->next)
+            if (pstorage->type == TLM_PORT || pstorage->type == TLM2_PORT)
+                fprintf(output, "%sif (ac_shared_size) %s.set_shared_region(ac_shared_start, ac_shared_size);\n",
+                        INDENT[1], pstorage->name);
+    }
 
     for (pstorage = storage_list; pstorage != NULL; pstorage=pstorage->next) {
         switch(pstorage->type) {
             case CACHE:
             case ICACHE:
             case DCACHE:
+                if (ACRuntimeCaches && pstorage->parms)
+                    fprintf(output, "%sif (ac_cache_configs.find(\"%s\") != ac_cache_configs.end()) "
+                            "%s.configure(ac_cache_configs[\"%s\"]);\n",
+                            INDENT[1], pstorage->name, pstorage->name, pstorage->name);
+                if (pstorage->parms)
+                    fprintf(output, "%sif (ac_cache_restores.find(\"%s\") != ac_cache_restores.end()) "
+                            "%s.restore_state(ac_cache_restores[\"%s\"]);\n",
+                            INDENT[1], pstorage->name, pstorage->name, pstorage->name);
+                if (pstorage->parms && !IsCacheLevel(pstorage))
+                    fprintf(output, "%sif (ac_cache_sampling.find(\"%s\") != ac_cache_sampling.end()) "
+                            "%s.set_sampling(ac_cache_sampling[\"%s\"]);\n",
+                            INDENT[1], pstorage->name, pstorage->name, pstorage->name);
+                //Misses of the fetch cache hold the processor until the
+                //instruction comes back, so only data caches overlap them.
+                if (pstorage->parms && !IsCacheLevel(pstorage) && ACWaitFlag &&
+                    (pstorage == fetch_device || pstorage->type == ICACHE)) {
+                    fprintf(output, "%sif (ac_cache_mshrs.find(\"%s\") != ac_cache_mshrs.end()) {\n",
+                            INDENT[1], pstorage->name);
+                    fprintf(output, "%scerr << \"ArchC: --cache-mshrs: %s fetches instructions, which wait for their misses.\" << endl;\n",
+                            INDENT[2], pstorage->name);
+                    fprintf(output, "%sexit(EXIT_FAILURE);\n", INDENT[2]);
+                    fprintf(output, "%s}\n", INDENT[1]);
+                }
+                else if (pstorage->parms && !IsCacheLevel(pstorage) && ACWaitFlag)
+                    fprintf(output, "%sif (ac_cache_mshrs.find(\"%s\") != ac_cache_mshrs.end()) "
+                            "%s.set_nonblocking(ac_cache_mshrs[\"%s\"], ac_cache_miss_latencies[\"%s\"], &cache_clock);\n",
+                            INDENT[1], pstorage->name, pstorage->name, pstorage->name, pstorage->name);
+                if (pstorage->parms && !IsCacheLevel(pstorage))
+                    fprintf(output, "%sif (ac_cache_attribution_top.find(\"%s\") != ac_cache_attribution_top.end()) "
+                            "%s.set_attribution(ac_cache_attribution_top[\"%s\"], ac_cache_attribution_dumps[\"%s\"], args.app_filename);\n",
+                            INDENT[1], pstorage->name, pstorage->name, pstorage->name, pstorage->name);
                 fprintf(output, "%sif (ac_cache_traces.find(\"%s\") != ac_cache_traces.end()) "
-                        "%s.set_trace(*ac_cache_traces[\"%s\"]);\n",
-                        INDENT[1], pstorage->name, pstorage->name, pstorage->name);
+                        "%s.set_trace(*ac_cache_traces[\"%s\"], (trace_format) ac_cache_trace_formats[\"%s\"]);\n",
+                        INDENT[1], pstorage->name, pstorage->name, pstorage->name, pstorage->name);
 
             default: continue;
 
@@ -2259,6 +2515,24 @@ void CreateProcessorImpl() {
     fprintf(output, "%scerr << endl << \"ArchC: -------------------- Simulation Finished --------------------\" << endl;\n", 
             INDENT[1]);
     fprintf(output, "%sISA._behavior_end();\n", INDENT[1]);
+
+    for (pstorage = storage_list; pstorage != NULL; pstorage=pstorage->next) {
+        switch(pstorage->type) {
+            case CACHE:
+            case ICACHE:
+            case DCACHE:
+                if (pstorage->parms)
+                    fprintf(output, "%sif (ac_cache_saves.find(\"%s\") != ac_cache_saves.end()) "
+                            "%s.save_state(ac_cache_saves[\"%s\"]);\n",
+                            INDENT[1], pstorage->name, pstorage->name, pstorage->name);
+                continue;
+            case TLM2_NB_PORT:
+                /* writes are posted: let the last ones reach memory */
+                fprintf(output, "%s%s.flush();\n", INDENT[1], pstorage->name);
+            default: continue;
+        }
+    }
+
     fprintf(output, "%sac_stop_flag = 1;\n", INDENT[1]);
     fprintf(output, "%sac_exit_status = status;\n", INDENT[1]);
     fprintf(output, "%sset_stopped();\n", INDENT[1]);
@@ -2337,7 +2611,10 @@ void CreateProcessorImpl() {
         }
     }
 
-
+    if (ACWaitFlag) {
+        fprintf(output, "%sstd::cerr << \"quantum:\\n\";\n", INDENT[1]);
+        fprintf(output, "%sac_qk.print_statistics(std::cerr);\n", INDENT[1]);
+    }
 
     fprintf(output, "}\n\n");
 
@@ -2451,7 +2728,40 @@ void CreateArchImpl() {
                     fprintf(output, "%s%s(*this, %s)", INDENT[1], pstorage->name, pstorage->name);
                 } else {
                     //It is an ac_cache object.
-                    fprintf(output, "%s%s(%s_mport,globalId)", INDENT[1], pstorage->name, pstorage->higher->name);
+                    if (IsCacheLevel(pstorage)) {
+                        struct CacheObject *c = pstorage->cache_object;
+                        const char *suffix = "";
+
+                        if (!IsCacheLevel(pstorage->higher)) {
+                            fprintf(output, "%s%s_next(%s_mport),\n", INDENT[1], pstorage->name,
+                                    pstorage->higher->name);
+                            suffix = "_next";
+                        }
+                        if (c->shared)
+                            fprintf(output, "%s%s(%s::shared(\"%s\", %s%s, ", INDENT[1], pstorage->name,
+                                    pstorage->class_declaration, pstorage->name,
+                                    pstorage->higher->name, suffix);
+                        else
+                            fprintf(output, "%s%s(%s%s, ", INDENT[1], pstorage->name,
+                                    pstorage->higher->name, suffix);
+                        fprintf(output, "ac_cache_geometry(%uU, %uU, %uU, \"%s\", %s), %s)%s",
+                                c->block_count * c->block_size, c->associativity, c->block_size,
+                                RuntimePolicyName[c->replacement_policy],
+                                (c->type == WriteThrough) ? "true" : "false",
+                                InclusionName[c->inclusion], c->shared ? ")" : "");
+                    }
+                    else if (ACRuntimeCaches) {
+                        struct CacheObject *c = pstorage->cache_object;
+                        fprintf(output, "%s%s(%s%s, ac_cache_geometry(%uU, %uU, %uU, \"%s\", %s), globalId)",
+                                INDENT[1], pstorage->name, pstorage->higher->name,
+                                IsCacheLevel(pstorage->higher) ? "" : "_mport",
+                                c->block_count * c->block_size, c->associativity, c->block_size,
+                                RuntimePolicyName[c->replacement_policy],
+                                (c->type == WriteThrough) ? "true" : "false");
+                    }
+                    else
+                        fprintf(output, "%s%s(%s%s,globalId)", INDENT[1], pstorage->name, pstorage->higher->name,
+                                IsCacheLevel(pstorage->higher) ? "" : "_mport");
 
                     if (HaveMemHier && pstorage->level == 0) {
                         fprintf(output, ",\n%s%s_if(%s)", INDENT[1], pstorage->name, pstorage->name);
@@ -2527,6 +2837,19 @@ void CreateArchImpl() {
 
     fprintf(output, "%sDATA_PORT = &%s_mport;\n", INDENT[1], first_level_data_device->name);
 
+    /* Data accesses are profiled at the data port. Instructions are
+       profiled per executed instruction, since fetches through the port
+       are filtered by the decoder cache. */
+    if (ACCacheAnalysis)
+      fprintf(output, "%sDATA_PORT->set_cache_analysis(&data_analysis);\n", INDENT[1]);
+
+    /* PC-indexed prefetchers and miss attribution read the program counter */
+    if (HaveMemHier)
+      for (pstorage = storage_list; pstorage != NULL; pstorage = pstorage->next)
+        if ((pstorage->type == CACHE || pstorage->type == ICACHE || pstorage->type == DCACHE) &&
+            pstorage->cache_object != NULL && !IsCacheLevel(pstorage))
+          fprintf(output, "%s%s.set_pc(&ac_pc.read());\n", INDENT[1], pstorage->name);
+
     fprintf( output, "}\n\n");
 
     fprintf( output, "int %s_arch::globalId = 0;", project_name);
@@ -2562,7 +2885,10 @@ void CreateMainTmpl() {
   fprintf( output, "#include  \"%s.H\"\n\n", project_name);
 
   fprintf( output, "\n\n");
-  fprintf( output, "int sc_main(int ac, char *av[])\n");
+  if (ACStandalone)
+    fprintf( output, "int main(int ac, char *av[])\n");
+  else
+    fprintf( output, "int sc_main(int ac, char *av[])\n");
   fprintf( output, "{\n\n");
 
   COMMENT(INDENT[1],"%sISA simulator", INDENT[1]);
@@ -2581,7 +2907,10 @@ void CreateMainTmpl() {
   fprintf(output, "%s%s_proc1.set_prog_args();\n", INDENT[1], project_name);
   fprintf(output, "%scerr << endl;\n\n", INDENT[1]);
 
-  fprintf(output, "%ssc_start();\n\n", INDENT[1]);
+  if (ACStandalone)
+    fprintf(output, "%s%s_proc1.run();\n\n", INDENT[1], project_name);
+  else
+    fprintf(output, "%ssc_start();\n\n", INDENT[1]);
 
   fprintf(output, "%s%s_proc1.PrintStat();\n", INDENT[1], project_name);
   fprintf(output, "%scerr << endl;\n\n", INDENT[1]);
@@ -3280,12 +3609,22 @@ void CreateMakefile(){
 
   fprintf( output, "\n\n");
 
-  fprintf( output, "INC_DIR := -I. `pkg-config --cflags systemc` `pkg-config --cflags archc` ");
+  //Standalone simulators take SystemC stand-ins from archc-standalone.
+  if (ACStandalone)
+    fprintf( output, "INC_DIR := -I. `pkg-config --cflags archc-standalone` ");
+  else
+    fprintf( output, "INC_DIR := -I. `pkg-config --cflags systemc` `pkg-config --cflags archc` ");
   if (HaveTLMPorts || HaveTLMIntrPorts || HaveTLM2Ports || HaveTLM2NBPorts || HaveTLM2IntrPorts)
      fprintf(output, "`pkg-config --cflags tlm`");
 
-  fprintf( output, "\n\nLIB_SYSTEMC := `pkg-config --libs systemc`\n");
-  fprintf( output, "LIB_ARCHC := `pkg-config --libs archc`\n");
+  if (ACStandalone) {
+    fprintf( output, "\n\nLIB_SYSTEMC :=\n");
+    fprintf( output, "LIB_ARCHC := `pkg-config --libs archc-standalone`\n");
+  }
+  else {
+    fprintf( output, "\n\nLIB_SYSTEMC := `pkg-config --libs systemc`\n");
+    fprintf( output, "LIB_ARCHC := `pkg-config --libs archc`\n");
+  }
   fprintf( output, "LIB_POWERSC := %s\n", (ACPowerEnable) ? "`pkg-config --libs powersc`" : "");
   fprintf( output, "LIB_DWARF := %s\n", (ACHLTraceFlag) ? "-ldw -lelf" : "" );
   fprintf( output, "LIBS := $(LIB_SYSTEMC) $(LIB_ARCHC) $(LIB_POWERSC) $(LIB_DWARF) -lm $(EXTRA_LIBS)\n");
@@ -3302,6 +3641,18 @@ void CreateMakefile(){
   if ( ac_match_endian )
     fprintf( output, " -DAC_MATCH_ENDIANNESS");
 
+  //!< Memories keep guest words in host byte order?
+  if ( ACHostNativeMem )
+    fprintf( output, " -DAC_HOST_NATIVE_STORAGE");
+
+  //!< Stack distance profiling of instruction and data streams?
+  if ( ACCacheAnalysis )
+    fprintf( output, " -DAC_CACHE_ANALYSIS");
+
+  //!< Processors on host threads?
+  if ( ACParallel )
+    fprintf( output, " -pthread");
+
   fprintf( output, " %s", OTHER_FLAGS);
 
   fprintf( output, "CFLAGS := $(DEBUG) $(OPT) $(OTHER) %s %s\n",
@@ -3484,6 +3835,43 @@ void CreateMakefile(){
 // These Functions are used by the Create functions declared above to write files //
 ////////////////////////////////////////////////////////////////////////////////////
 
+/**************************************/
+/*!  Emits the test for pending interrupts at a safe point:
+  after jumps and branches, at quantum syncs or, in models with
+  neither, before every instruction.
+  \brief Used by EmitUpdateMethod and EmitInstrExec functions */
+/***************************************/
+void EmitIntrCheck(FILE *output, int base_indent) {
+  fprintf(output, "%sif (intr_queue.is_pending() || intr_reg.read() == 0)  handle_interrupts();\n",
+          INDENT[base_indent]);
+}
+
+/**************************************/
+/*!  Emits handle_interrupts(), which runs the deferred interrupt
+  handlers on the processor's thread and sleeps while intr_reg is 0
+  (SLEEP MODE) until an interrupt arrives.
+  \brief Used by CreateProcessorImpl function */
+/***************************************/
+void EmitIntrHandling(FILE *output) {
+  fprintf(output, "void %s::handle_interrupts() {\n", project_name);
+  fprintf(output, "%sfor (;;) {\n", INDENT[1]);
+  if (ACParallel) {
+    /* handlers notify SystemC events: run them on the SystemC side */
+    fprintf(output, "%sif (intr_queue.is_pending())\n", INDENT[2]);
+    fprintf(output, "%sac_parallel::serial([this] { intr_queue.handle_pending(); });\n", INDENT[3]);
+  }
+  else
+    fprintf(output, "%sintr_queue.handle_pending();\n", INDENT[2]);
+  fprintf(output, "%sif (intr_reg.read() != 0)\n", INDENT[2]);
+  fprintf(output, "%sreturn;\n", INDENT[3]);
+  if (ACParallel)
+    fprintf(output, "%sac_parallel::idle(ac_qk);\n", INDENT[2]);
+  else
+    fprintf(output, "%swait(wake);\n", INDENT[2]);
+  fprintf(output, "%s}\n", INDENT[1]);
+  fprintf(output, "}\n\n");
+}
+
 /**************************************/
 /*!  Emits a method to update pipe regs
   \brief Used by EmitProcessorBhv and EmitDispatch functions      */
@@ -3536,9 +3924,16 @@ void EmitUpdateMethod( FILE *output, int base_indent ) {
   
   if (ACWaitFlag) {
     fprintf(output, "%sif (ac_qk.need_sync()) {\n", INDENT[base_indent]);
-    fprintf(output, "%sac_qk.sync();\n", INDENT[base_indent + 1]);
+    if (ACParallel)
+      fprintf(output, "%sac_parallel::sync(ac_qk);\n", INDENT[base_indent + 1]);
+    else
+      fprintf(output, "%sac_qk.sync();\n", INDENT[base_indent + 1]);
+    if (ACDeferredIntr)
+      EmitIntrCheck(output, base_indent + 1);
     fprintf(output, "%s}\n", INDENT[base_indent]);
   }
+  else if (ACDeferredIntr && !HaveControlFlowInstrs())
+    EmitIntrCheck(output, base_indent);
 }
 
 
@@ -3665,6 +4060,9 @@ void EmitInstrExecIni( FILE *output, int base_indent) {
     fprintf( output, "%sif (gdbstub && gdbstub->stop(ac_pc)) gdbstub->process_bp();\n\n", 
              INDENT[base_indent]);
 
+  if( ACCacheAnalysis )
+    fprintf( output, "%sinst_analysis.access(ac_pc);\n\n", INDENT[base_indent]);
+
   if ( ACCurInstrID )
     fprintf(output, "%sISA.cur_instr_id = ins_id;\n", INDENT[base_indent]);
   
@@ -3720,7 +4118,10 @@ void EmitInstrExec( FILE *output, int base_indent){
                         INDENT[base_indent], project_name);
             }
 
-            fprintf( output, "%sISA.syscall.NAME(); \\\n", INDENT[base_indent]);
+            if (ACParallel)
+                fprintf( output, "%sac_parallel::begin_exclusive(); ISA.syscall.NAME(); ac_parallel::end_exclusive(); \\\n", INDENT[base_indent]);
+            else
+                fprintf( output, "%sISA.syscall.NAME(); \\\n", INDENT[base_indent]);
             fprintf( output, "%sgoto *dispatch();\n\n", INDENT[base_indent]);
             base_indent--;
 
@@ -3816,6 +4217,9 @@ void EmitInstrExec( FILE *output, int base_indent){
             fprintf(output, "%sac_qk.inc(sc_time(module_period_ns*%d, SC_NS));\n", INDENT[base_indent + 1], pinstr->cycles);
         }
 
+        if( ACDeferredIntr && pinstr->cflow )
+            EmitIntrCheck(output, base_indent + 1);
+
         if( ACThreading )
             fprintf(output, "%sgoto *dispatch();\n\n", INDENT[base_indent + 1]);
         else
@@ -3910,7 +4314,10 @@ void EmitProcessorBhv( FILE *output, int base_indent ) {
       fprintf( output, "%sgenerate_trace_for_address(ac_pc);\\\n", INDENT[base_indent]);
     }
 
-    fprintf( output, "%sISA.syscall.NAME(); \\\n", INDENT[base_indent]);
+    if (ACParallel)
+      fprintf( output, "%sac_parallel::begin_exclusive(); ISA.syscall.NAME(); ac_parallel::end_exclusive(); \\\n", INDENT[base_indent]);
+    else
+      fprintf( output, "%sISA.syscall.NAME(); \\\n", INDENT[base_indent]);
     
     if (ACSyscallJump)
       fprintf( output, "%sexec = false; \\\n", INDENT[base_indent]);
@@ -4269,7 +4676,7 @@ void EmitDispatch(FILE *output, int base_indent) {
   base_indent++;
 
 
- if (HaveTLMIntrPorts || HaveTLM2IntrPorts)
+ if ((HaveTLMIntrPorts || HaveTLM2IntrPorts) && !ACDeferredIntr)
   {
     fprintf(output, "%s/*************************************************************************************/\n",INDENT[base_indent]);
     fprintf(output, "%s/* SLEEP / AWAKE mode control                                                        */\n",INDENT[base_indent]);
@@ -4278,7 +4685,10 @@ void EmitDispatch(FILE *output, int base_indent) {
     fprintf(output, "%s/* wake - this event will happen in the moment the processor receives and            */\n",INDENT[base_indent]);
     fprintf(output, "%s/* interrupt with code AWAKE (1)                                                     */\n",INDENT[base_indent]);    
     fprintf(output, "%s/*************************************************************************************/\n",INDENT[base_indent]);
-    fprintf(output, "%sif (intr_reg.read() == 0)  wait(wake);\n",INDENT[base_indent]);  
+    if (ACParallel)
+      fprintf(output, "%swhile (intr_reg.read() == 0)  ac_parallel::idle(ac_qk);\n",INDENT[base_indent]);
+    else
+      fprintf(output, "%sif (intr_reg.read() == 0)  wait(wake);\n",INDENT[base_indent]);  
   }
 
 
@@ -4330,7 +4740,10 @@ void EmitDispatch(FILE *output, int base_indent) {
       fprintf( output, "%sgenerate_trace_for_address(ac_pc);\\\n", INDENT[base_indent]);
     }
 
-    fprintf( output, "%sISA.syscall.NAME(); \\\n", INDENT[base_indent]);
+    if (ACParallel)
+      fprintf( output, "%sac_parallel::begin_exclusive(); ISA.syscall.NAME(); ac_parallel::end_exclusive(); \\\n", INDENT[base_indent]);
+    else
+      fprintf( output, "%sISA.syscall.NAME(); \\\n", INDENT[base_indent]);
     
     if (ACSyscallJump)
       fprintf( output, "%sexec = false; \\\n", INDENT[base_indent]);
@@ -4641,15 +5054,93 @@ void ParseCache(ac_sto_list * cache_in)
         {
             cache_out->replacement_policy = LRU;
         }
+        else if (!strcmp(p->str, "treeplru") || !strcmp(p->str, "TREEPLRU"))
+        {
+            cache_out->replacement_policy = TreePLRU;
+        }
+        else if (!strcmp(p->str, "srrip") || !strcmp(p->str, "SRRIP"))
+        {
+            cache_out->replacement_policy = SRRIP;
+        }
+        else if (!strcmp(p->str, "brrip") || !strcmp(p->str, "BRRIP"))
+        {
+            cache_out->replacement_policy = BRRIP;
+        }
+        else if (!strcmp(p->str, "drrip") || !strcmp(p->str, "DRRIP"))
+        {
+            cache_out->replacement_policy = DRRIP;
+        }
         else
         {
           AC_ERROR("Invalid parameter in cache declaration: %s\n", cache_in->name);
           printf("The fifth parameter must be a valid replacement strategy:"     
-         "\"plrum\", \"random\", \"fifo\" or \"lru\" (or \"none\" for direct-mapped caches.\")\n");
+         "\"plrum\", \"random\", \"fifo\", \"lru\", \"treeplru\", \"srrip\", \"brrip\" or \"drrip\" (or \"none\" for direct-mapped caches.\")\n");
           exit(EXIT_FAILURE);
         }
      
     }
+
+    // 6th parameter (optional)
+    p = p->next;
+    cache_out->prefetcher = NoPrefetch;
+    if (p != NULL)
+    {
+        if (!strcmp(p->str, "nextline") || !strcmp(p->str, "NEXTLINE"))
+            cache_out->prefetcher = NextLine;
+        else if (!strcmp(p->str, "stride") || !strcmp(p->str, "STRIDE"))
+            cache_out->prefetcher = Stride;
+        else if (!strcmp(p->str, "stream") || !strcmp(p->str, "STREAM"))
+            cache_out->prefetcher = Stream;
+        else if (strcmp(p->str, "none") && strcmp(p->str, "NONE"))
+        {
+          AC_ERROR("Invalid parameter in cache declaration: %s\n", cache_in->name);
+          printf("The sixth parameter must be a valid prefetcher:"
+         "\"nextline\", \"stride\", \"stream\" or \"none\"\n");
+          exit(EXIT_FAILURE);
+        }
+        p = p->next;
+    }
+
+    // 7th and 8th parameters (optional): inclusion and sharing of a cache
+    // bound under another cache
+    cache_out->inclusion = NINE;
+    cache_out->shared = 0;
+    if (p != NULL)
+    {
+        if (!strcmp(p->str, "inclusive") || !strcmp(p->str, "INCLUSIVE"))
+            cache_out->inclusion = Inclusive;
+        else if (!strcmp(p->str, "exclusive") || !strcmp(p->str, "EXCLUSIVE"))
+            cache_out->inclusion = Exclusive;
+        else if (strcmp(p->str, "nine") && strcmp(p->str, "NINE"))
+        {
+          AC_ERROR("Invalid parameter in cache declaration: %s\n", cache_in->name);
+          printf("The seventh parameter must be a valid inclusion policy:"
+         "\"inclusive\", \"exclusive\" or \"nine\"\n");
+          exit(EXIT_FAILURE);
+        }
+        p = p->next;
+    }
+    if (p != NULL)
+    {
+        if (!strcmp(p->str, "shared") || !strcmp(p->str, "SHARED"))
+            cache_out->shared = 1;
+        else if (strcmp(p->str, "private") && strcmp(p->str, "PRIVATE"))
+        {
+          AC_ERROR("Invalid parameter in cache declaration: %s\n", cache_in->name);
+          printf("The eighth parameter must be \"shared\" or \"private\"\n");
+          exit(EXIT_FAILURE);
+        }
+        p = p->next;
+    }
+    if (p != NULL)
+    {
+        AC_ERROR("Invalid parameter in cache declaration: %s\n", cache_in->name);
+        printf("A cache takes at most eight parameters, \"%s\" is one too many\n", p->str);
+        exit(EXIT_FAILURE);
+    }
+    if (cache_in->level == 0 && (cache_out->inclusion != NINE || cache_out->shared))
+        AC_MSG("Warning: Cache %s: inclusion and sharing only apply to caches bound under another cache and will be ignored.\n",
+               cache_in->name);
 }
 
 void TLMMemoryClassDeclaration(ac_sto_list * memory)
@@ -4675,11 +5166,31 @@ void TLMMemoryClassDeclaration(ac_sto_list * memory)
 }*/
 
 
+//! Is the storage an ac_cache object bound under another cache?
+int IsCacheLevel(ac_sto_list * storage)
+{
+    return (storage->type == CACHE || storage->type == ICACHE || storage->type == DCACHE) &&
+           storage->parms != NULL && storage->level > 0;
+}
+
+//! Does the model declare jumps or branches (is_jump/is_branch)?
+int HaveControlFlowInstrs(void)
+{
+    extern ac_dec_instr *instr_list;
+    ac_dec_instr *pinstr;
+
+    for (pinstr = instr_list; pinstr != NULL; pinstr = pinstr->next)
+        if (pinstr->cflow != NULL)
+            return 1;
+    return 0;
+}
+
 void CacheClassDeclaration(ac_sto_list * storage)
 {
     const unsigned s = 800;
     extern char *project_name;
     struct CacheObject *cache = storage->cache_object;
+    char backing_store[800];
     if (storage->higher->class_declaration == NULL) {
         if (storage->higher->type == MEM || storage->higher->type == TLM_PORT ||
             storage->higher->type == TLM2_PORT ||
@@ -4692,15 +5203,93 @@ void CacheClassDeclaration(ac_sto_list * storage)
         }
     }
     storage->class_declaration = malloc(s);
+
+    // Caches bound under another cache are levels of a hierarchy, linked
+    // to the caches above through ac_cache_memory.
+    if (storage->level > 0) {
+        // a shared level goes on through the memory of the first processor
+        // building it, which must be the memory of every other one too
+        if (cache->shared &&
+            !(storage->higher->type == TLM_PORT || storage->higher->type == TLM2_PORT ||
+              storage->higher->type == TLM2_NB_PORT ||
+              (IsCacheLevel(storage->higher) && storage->higher->cache_object->shared))) {
+            AC_ERROR("Cache %s: a shared cache must be bound to a TLM port or to another shared cache.\n",
+                     storage->name);
+            exit(EXIT_FAILURE);
+        }
+        if (cache->prefetcher != NoPrefetch)
+            AC_MSG("Warning: Cache %s: prefetchers are not supported below other caches and will be ignored.\n",
+                   storage->name);
+        if (snprintf(storage->class_declaration, s, "ac_cache_level<%s_parms::ac_word>",
+                     project_name) >= s)
+            abort();
+        return;
+    }
+    if (IsCacheLevel(storage->higher))
+        snprintf(backing_store, s, "ac_cache_memory<%s_parms::ac_word>", project_name);
+    else
+        snprintf(backing_store, s, "%s", storage->higher->class_declaration);
+
+    if (ACRuntimeCaches) {
+        if (cache->prefetcher != NoPrefetch)
+            AC_MSG("Warning: Cache %s: prefetchers are not supported with --runtime-caches and will be ignored.\n",
+                   storage->name);
+        if (snprintf(storage->class_declaration, s, "ac_runtime_cache<%s_parms::ac_word, %s>",
+                     project_name, backing_store) >= s)
+            abort();
+        return;
+    }
     int r = snprintf(storage->class_declaration, s,
-         "%s<%d, %d, %d, %s_parms::ac_word, %s, %s>", CacheName[cache->type],
+         "%s<%d, %d, %d, %s_parms::ac_word, %s, %s%s%s>", CacheName[cache->type],
          cache->block_count / cache->associativity, cache->block_size,
-         cache->associativity, project_name, storage->higher->class_declaration,
-         ReplacementPolicyName[cache->replacement_policy]);
+         cache->associativity, project_name, backing_store,
+         ReplacementPolicyName[cache->replacement_policy],
+         (cache->prefetcher != NoPrefetch) ? ", unsigned, " : "",
+         (cache->prefetcher != NoPrefetch) ? PrefetcherName[cache->prefetcher] : "");
     if (r >= s)
   abort();
 }
 
+/* The simulator builds its caches in storage list order, and each takes a
+   reference to the level under it: move deeper levels ahead of the caches
+   bound to them, keeping every other device where it is. */
+static void OrderCacheLevels()
+{
+    extern ac_sto_list *storage_list;
+    ac_sto_list *i, *x, **nodes, **caches;
+    unsigned n = 0, c = 0, j, k;
+
+    for (i = storage_list; i != NULL; i = i->next)
+        n++;
+    if (n == 0)
+        return;
+    nodes = malloc(n * sizeof(*nodes));
+    caches = malloc(n * sizeof(*caches));
+    for (i = storage_list, j = 0; i != NULL; i = i->next, j++) {
+        nodes[j] = i;
+        if (i->cache_object != NULL)
+            caches[c++] = i;
+    }
+
+    // stable insertion sort, deepest level first
+    for (j = 1; j < c; j++) {
+        x = caches[j];
+        for (k = j; k > 0 && caches[k-1]->level < x->level; k--)
+            caches[k] = caches[k-1];
+        caches[k] = x;
+    }
+    for (j = 0, k = 0; j < n; j++)
+        if (nodes[j]->cache_object != NULL)
+            nodes[j] = caches[k++];
+
+    storage_list = nodes[0];
+    for (j = 0; j + 1 < n; j++)
+        nodes[j]->next = nodes[j+1];
+    nodes[n-1]->next = NULL;
+    free(nodes);
+    free(caches);
+}
+
 void EnumerateCaches()
 {
     extern ac_sto_list *storage_list;
@@ -4708,12 +5297,14 @@ void EnumerateCaches()
     for (i = storage_list; i != NULL; i = i->next) {
         //printf("\nprinting i->type = %d", i->type);
         if (i->type == ICACHE || i->type == DCACHE || i->type == CACHE) {
-           if (i->parms != NULL) {
+           // levels under other caches are declared along with them
+           if (i->parms != NULL && i->class_declaration == NULL) {
     ParseCache(i);
     CacheClassDeclaration(i);
       }
   }
     }
+    OrderCacheLevels();
 }
 
 void GetFetchDevice()
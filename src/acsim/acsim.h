@@ -124,6 +124,12 @@ enum _ac_cmd_options {
   OPFullDecode,
   OPCurInstrID,
   OPPower,
+  OPHostNativeMem,
+  OPCacheAnalysis,
+  OPRuntimeCaches,
+  OPParallel,
+  OPDeferredIntr,
+  OPStandalone,
   ACNumberOfOptions,
 };
 
@@ -145,6 +151,10 @@ enum CacheReplacementPolicy {
   Random,
   PLRUM,
   LRU,
+  TreePLRU,
+  SRRIP,
+  BRRIP,
+  DRRIP,
   None
 };
 
@@ -153,9 +163,55 @@ static const char *ReplacementPolicyName[] = {
   [Random] = "ac_random_replacement_policy",
   [PLRUM] = "ac_plrum_replacement_policy",
   [LRU] = "ac_lru_replacement_policy",
+  [TreePLRU] = "ac_tree_plru_replacement_policy",
+  [SRRIP] = "ac_srrip_replacement_policy",
+  [BRRIP] = "ac_brrip_replacement_policy",
+  [DRRIP] = "ac_drrip_replacement_policy",
   [None] = "ac_fifo_replacement_policy" // placeholder
 };
 
+// Policy names as taken by ac_cache_geometry (--runtime-caches)
+static const char *RuntimePolicyName[] = {
+  [FIFO] = "fifo",
+  [Random] = "random",
+  [PLRUM] = "plrum",
+  [LRU] = "lru",
+  [TreePLRU] = "treeplru",
+  [SRRIP] = "srrip",
+  [BRRIP] = "brrip",
+  [DRRIP] = "drrip",
+  [None] = "fifo" // placeholder
+};
+
+
+enum CachePrefetcher {
+  NoPrefetch,
+  NextLine,
+  Stride,
+  Stream
+};
+
+static const char *PrefetcherName[] = {
+  [NoPrefetch] = "ac_no_prefetcher",
+  [NextLine] = "ac_next_line_prefetcher",
+  [Stride] = "ac_stride_prefetcher",
+  [Stream] = "ac_stream_prefetcher"
+};
+
+
+// How a cache bound under another cache relates to it (see ac_cache_level)
+enum CacheInclusion {
+  NINE,
+  Inclusive,
+  Exclusive
+};
+
+static const char *InclusionName[] = {
+  [NINE] = "ac_nine",
+  [Inclusive] = "ac_inclusive",
+  [Exclusive] = "ac_exclusive"
+};
+
 
 struct CacheObject {
   enum CacheType type;
@@ -163,6 +219,9 @@ struct CacheObject {
   unsigned block_size;
   unsigned associativity;
   enum CacheReplacementPolicy replacement_policy;
+  enum CachePrefetcher prefetcher;
+  enum CacheInclusion inclusion;
+  int shared; // one level for all processor instances
 };
 
 
@@ -226,6 +285,8 @@ void EmitDecCache(FILE *output, int base_indent);
 void EmitDecCacheAt(FILE *output, int base_indent);                                //!< Emits a Decoder Cache Attribution
 void EmitDispatch(FILE *output, int base_indent);                                  //!< Emits the Dispatch Function used by Threading
 void EmitVetLabelAt(FILE *output, int base_indent);                                //!< Emits the Vector with Address of the Interpretation Routines used by Threading
+void EmitIntrCheck(FILE *output, int base_indent);                                 //!< Emits the test for pending interrupts at a safe point
+void EmitIntrHandling(FILE *output);                                               //!< Emits the method that runs deferred interrupt handlers
 //@}
 
 /** @defgroup utilitfunc Utility Functions
@@ -235,6 +296,8 @@ void EmitVetLabelAt(FILE *output, int base_indent);
  */
 void ReadConfFile(void);                          //!< Read archc.conf contents.
 void ParseCache(ac_sto_list *cache_in);
+int IsCacheLevel(ac_sto_list *storage);
+int HaveControlFlowInstrs(void);
 void CacheClassDeclaration(ac_sto_list *storage);
 void MemoryClassDeclaration(ac_sto_list *memory);
 void TLMMemoryClassDeclaration(ac_sto_list *memory);